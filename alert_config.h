@@ -0,0 +1,16 @@
+// Regras de alerta por andar (formato em inc/alerts.h, alerts_load). Cada
+// linha: above|below <andar|*> <limite> [<histerese> [<segundos>]].
+//
+// Exemplos:
+//   above 2 40 5 300    andar 2 com mais de 40 pessoas por 5 minutos seguidos;
+//                       volta ao normal com 35 ou menos
+//   below * 1           andar vazio (um alerta por andar)
+
+#ifndef ALERT_CONFIG_H
+#define ALERT_CONFIG_H
+
+static const char ALERT_CONFIG[] =
+    "above * 45 5\n"
+    "above * 40 5 600\n";
+
+#endif // ALERT_CONFIG_H
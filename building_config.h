@@ -0,0 +1,24 @@
+// Modelo do prédio carregado no boot (formato em inc/building.h, building_load).
+// Um andar sem linhas "zone" tem uma única zona com capacidade 50.
+//
+// Exemplo com zonas e mais de um prédio:
+//   building Sede
+//   floor Terreo
+//   zone 40 Recepcao
+//   zone 120 Auditorio
+//   floor Andar 1
+//   building Anexo
+//   floor Terreo
+
+#ifndef BUILDING_CONFIG_H
+#define BUILDING_CONFIG_H
+
+static const char BUILDING_CONFIG[] =
+    "building Predio\n"
+    "floor Terreo\n"
+    "floor Andar 1\n"
+    "floor Andar 2\n"
+    "floor Andar 3\n"
+    "floor Andar 4\n";
+
+#endif // BUILDING_CONFIG_H
@@ -21,13 +21,35 @@
  #include "pico/stdlib.h"
  #include "hardware/i2c.h"
  #include "hardware/pio.h"
+ #include "hardware/watchdog.h"
  #include "ws2812.pio.h"      // Cabeçalho gerado a partir do ws2812.pio
+ #include "web_app.h"         // web/app.js comprimido (gerado no build)
  #include "pico/binary_info.h"
+ #include "pico/rand.h"
  #include "pico/cyw43_arch.h"
- #include "lwip/tcp.h"
+ #include "pico/multicore.h"
+ #include "pico/flash.h"
+ #include "pico/util/queue.h"
+ #include "lwip/altcp_tcp.h"
  #include "lwip/inet.h"
  #include "dhcpserver/dhcpserver.h"
  #include "dnsserver/dnsserver.h"
+ #include "http_parser.h"
+ #include "websocket.h"
+ #include "building.h"
+ #include "event_log.h"
+ #include "flash_store.h"
+ #include "config_store.h"
+ #include "timeseries.h"
+ #include "minute_index.h"
+ #include "seqlock.h"
+ #include "presence.h"
+ #include "alerts.h"
+ #include "building_config.h" // prédios, andares e zonas (sem configuração enviada)
+ #include "alert_config.h"    // regras de alerta por andar
+ #if HTTPS_ENABLED
+ #include "tls_server.h"
+ #endif
  
  // Drivers do display OLED – API baseada em ssd1306_t (BitDogLab)
  #include "ssd1306.h"       // Declarações, comandos e protótipos para o SSD1306
@@ -39,6 +61,7 @@
  #include <stdlib.h>
  #include <ctype.h>
  #include <stdbool.h>
+ #include <stdarg.h>
  #include <time.h>
  
  /* ─── DEFINIÇÕES DE HARDWARE ───────────────────────────────────────────── */
@@ -69,22 +92,138 @@
  // Configurações da matriz de LED WS2812 (5x5)
  #define WS2812_PIN 7
  #define IS_RGBW false
+
+ // OLED e matriz são desenhados no core1 (ver render_core1_main)
+ #define RENDER_QUEUE_DEPTH 8
+ #define RENDER_OLED        0x01
+ #define RENDER_MATRIX      0x02
  
  // Porta do servidor HTTP
  #define HTTP_PORT 80
+ // HTTPS opcional (cmake -DCHECKIN_HTTPS=ON, certificado em certs/; ver README).
+ // Cada conexão TLS reserva ~10 KB de heap para o mbedTLS, por isso o limite é
+ // menor que o do pool; as demais vagas continuam para HTTP.
+ #ifndef HTTPS_ENABLED
+   #define HTTPS_ENABLED 0
+ #endif
+ #define HTTPS_PORT 443
+ #define HTTPS_MAX_CONNECTIONS 2
+ // Endereço do Access Point (o mesmo configurado em main)
+ #define PORTAL_HOST "192.168.4.1"
+ 
+ // Portal cativo: o DNS responde qualquer nome com o IP da placa, então os
+ // testes de conectividade dos celulares chegam aqui. 0 = responde "internet
+ // ok" e o celular fica na rede sem abrir nada; 1 = redireciona para a página,
+ // e o sistema abre o portal assim que o celular conecta.
+ #define CAPTIVE_PORTAL_REDIRECT       0
+ 
+ // Conexões persistentes (HTTP/1.1 keep-alive)
+ #define HTTP_MAX_CONNECTIONS          6     // conexões simultâneas atendidas
+ #define HTTP_KEEPALIVE_TIMEOUT_S      15    // fecha conexões ociosas após N segundos
+ #define HTTP_KEEPALIVE_MAX_REQUESTS   100   // requisições por conexão antes de fechar
+ #define HTTP_POLL_INTERVAL            2     // altcp_poll em unidades de 500 ms
+ #define HTTP_REQUEST_TIMEOUT_S        5     // tempo máximo para uma requisição chegar inteira
+ #define HTTP_SEND_TIMEOUT_S           10    // tempo máximo sem ACK com dados pendentes
+ #define HTTP_LISTEN_BACKLOG           4     // conexões aceitas aguardando a 1ª requisição
+ #define HTTP_MIN_SNDBUF_PER_RESPONSE  2048  // espaço mínimo no buffer TCP para responder
+ 
+ // Página principal enviada em pedaços (Transfer-Encoding: chunked)
+ #define PAGE_CHUNK_MAX                (TCP_MSS - 8)  // dados por pedaço: um segmento
+ #define PAGE_CHUNK_OVERHEAD           8     // "5ac\r\n" + "\r\n"
+ #define PAGE_CHUNK_MIN                256   // espaço mínimo para gerar um pedaço
+ #define PAGE_CACHE_MAX                8192  // opções + linhas da tabela em cache
+ 
+ // Converte segundos em chamadas de altcp_poll
+ #define HTTP_POLL_TICKS(s)            ((s) * 1000 / (HTTP_POLL_INTERVAL * 500))
+ 
+ // A maior resposta (pacote do app) precisa caber de uma vez no espaço reservado
+ _Static_assert(WEB_APP_GZ_LEN + 256 <= HTTP_MIN_SNDBUF_PER_RESPONSE,
+                "web/app.js comprimido nao cabe em HTTP_MIN_SNDBUF_PER_RESPONSE");
+ 
+ // Interface: 0 = "/" entrega a página gerada no servidor; 1 = "/" entrega o
+ // app (mesmo de /app), que fica em cache e só busca os dados da ocupação
+ #define WEB_UI_SPA                    0
+ 
+ // Limite de requisições por cliente (token bucket por IP)
+ #define RATE_LIMIT_BURST              20    // requisições seguidas permitidas
+ #define RATE_LIMIT_PER_SEC            5     // requisições repostas por segundo
+ 
+ // Server-Sent Events (/events)
+ #define SSE_MAX_SUBSCRIBERS           3     // conexões /events simultâneas
+ #define SSE_HEARTBEAT_MS              15000 // intervalo do heartbeat (SSE e ping WebSocket)
+ 
+ // Histórico de alterações (GET /api/checkins)
+ #define CHECKINS_PAGE_MAX             32    // registros por resposta
+ 
+ // Persistência da ocupação na flash (ver flash_store.h)
+ #define FLASH_STORE_FLUSH_MS          2000  // intervalo entre gravações das alterações
+
+ // Atualização em lote (POST /api/batch)
+ #define BATCH_MAX_OPS                 64    // operações por requisição
+ #define BATCH_MAX_BODY                2048  // bytes máximos do corpo
+ #define BATCH_LINE_MAX                32    // "andar.zona,acao,valor"
+
+ // Configuração do prédio enviada por POST /api/config (ver config_store.h)
+ #define CONFIG_REBOOT_DELAY_MS        1000  // tempo para a resposta sair antes de reiniciar
+
+ // Check-in por crachá (ações checkin/checkout)
+ #define PRESENCE_TTL_MIN              720   // sem nova leitura por 12 h, o crachá sai
+ #define PRESENCE_SWEEP_MS             1000  // intervalo da verificação de vencidos
+ #define PRESENCE_SWEEP_SLOTS          256   // slots verificados por vez (tabela inteira em ~16 s)
+ 
+ // WebSocket (/ws) para os tablets da recepção
+ #define WS_MAX_CLIENTS                3     // conexões /ws simultâneas
  
  #ifndef CYW43_AUTH_WPA2_AES_PSK
    #define CYW43_AUTH_WPA2_AES_PSK 4
  #endif
  
- // Configurações de ocupação
- #define NUM_FLOORS     5
- #define MAX_OCCUPANCY  50  // controle via botões/HTTP
- // Para a matriz: 50 pessoas = linha completa de 5 LEDs (cada LED equivale a 10 pessoas)
+ // JSON do estado (/api/floors, snapshot de /events e /ws, resposta do lote):
+ // contagem, capacidade e nome de cada andar e os alertas ativos
+ #define STATE_JSON_MAX  (64 + BUILDING_MAX_FLOORS * (32 + 2 * BUILDING_NAME_MAX) + \
+                          ALERTS_MAX_RULES * (sizeof("[63,31,\"above\",65535],") - 1))
  
  /* ─── VARIÁVEIS GLOBAIS ───────────────────────────────────────────── */
- static int occupancy[NUM_FLOORS] = {0, 0, 0, 0, 0};
- static int selected_floor = 0;
+ // Ocupação por zona e totais por andar (ver building_config.h)
+ static building_model_t building;
+ static int selected_floor = 0;       // índice global do andar (todos os prédios)
+ // Escritas nas contagens e em selected_floor (sempre no core0, sob a trava do
+ // lwIP) ficam entre seqlock_write_begin/end; o core1 lê por take_snapshot
+ static seqlock_t state_lock;
+ // Histórico de alterações (GET /api/checkins)
+ static event_log_t checkin_log;
+ _Static_assert(BUILDING_MAX_ZONES - 1 <= EVENT_LOG_ZONE_MAX, "zona nao cabe em event_record_t");
+ // Contagens das zonas salvas na flash (gravadas pelo loop principal). Só a
+ // parte sem crachá vai para a flash: a tabela de crachás não é salva, então
+ // depois de um reinício não haveria como dar saída nem vencer esses crachás.
+ static flash_store_t occupancy_store;
+ static uint16_t zone_saved[BUILDING_MAX_ZONES];
+ _Static_assert(BUILDING_MAX_ZONES <= FLASH_STORE_MAX_VALUES, "zonas nao cabem no snapshot da flash");
+ // Crachás presentes e a zona de cada um (ações checkin/checkout)
+ static presence_table_t presence;
+ _Static_assert(BUILDING_MAX_ZONES <= UINT16_MAX, "zona nao cabe em presence_entry_t");
+ // Crachás presentes em cada zona: a parte da contagem que vem da tabela
+ static uint16_t zone_badges[BUILDING_MAX_ZONES];
+ // Ocupação de cada andar por minuto, hora e dia (GET /api/timeseries)
+ static timeseries_t occupancy_series;
+ _Static_assert(BUILDING_MAX_FLOORS <= TIMESERIES_MAX_FLOORS, "andares nao cabem em timeseries_t");
+ // Ocupação por minuto do último dia, indexada para somas e picos de faixas
+ // (GET /api/occupancy); com mais de 5 andares cada um guarda menos minutos
+ static minute_index_t minute_index;
+ _Static_assert(BUILDING_MAX_FLOORS <= MINUTE_INDEX_MAX_FLOORS, "andares nao cabem em minute_index_t");
+ // Regras de alerta (alert_config.h), avaliadas a cada alteração de um andar
+ static alerts_t alerts;
+ _Static_assert(BUILDING_MAX_FLOORS <= ALERTS_MAX_FLOORS, "andares nao cabem em alerts_t");
+ static const char *const alert_kind_names[] = {
+     [ALERT_ABOVE] = "above",
+     [ALERT_BELOW] = "below",
+ };
+ // Versão do estado (ocupação + andar selecionado). Toda alteração incrementa o
+ // contador, que identifica o estado no ETag de /api/floors.
+ static uint32_t state_version = 1;
+ // Identificador aleatório do boot, usado no ETag para que versões de uma
+ // execução anterior nunca coincidam com as da atual
+ static uint32_t boot_id = 0;
  
  // Objeto global para o display OLED
  ssd1306_t disp;
@@ -94,26 +233,59 @@
  uint sm_ws;
  uint offset_ws;
  
- /* ─── FUNÇÕES AUXILIARES PARA PARÂMETROS HTTP ──────────────────────────*/
- // Função genérica para extrair um parâmetro da query string
- static void parse_param(const char *request_line, const char *key, char *dest, size_t dest_size) {
-     dest[0] = '\0';
-     const char *p = strstr(request_line, key);
-     if (p) {
-         p += strlen(key);
-         size_t i = 0;
-         while (*p && *p != '&' && *p != ' ' && i < dest_size - 1) {
-             dest[i++] = *p++;
-         }
-         dest[i] = '\0';
-     }
- }
- 
+ // Pedidos de redesenho do core0 para o core1 (RENDER_*)
+ static queue_t render_queue;
+
+ // Cópia consistente do estado, desenhada pelo core1
+ typedef struct {
+     int selected;
+     uint32_t floor_count[BUILDING_MAX_FLOORS];
+     uint16_t zone_count[BUILDING_MAX_ZONES];
+     uint32_t alerts_active[ALERTS_WORDS];
+ } occupancy_snapshot_t;
+
+ // Usado só pelo core1 (e no boot, antes de ele começar)
+ static occupancy_snapshot_t render_snapshot;
+
  /* Protótipos */
- static void parse_query_params(const char *request_line, char *floor_str, size_t floor_len, char *action, size_t action_len, char *value_str, size_t value_len);
- void update_led_matrix(void);
+ void update_led_matrix(const occupancy_snapshot_t *s);
+ static void publish_floor(int floor);
+ static void publish_alerts(void);
+ static void request_render(uint32_t what);
  
  /* ─── FUNÇÕES AUXILIARES ───────────────────────────────────────────── */
+ // Nome do andar para exibição; com mais de um prédio, precedido pelo prédio
+ static int format_floor_name(char *buf, size_t size, int floor) {
+     const building_floor_t *f = &building.floors[floor];
+     if (building.num_buildings > 1) {
+          return snprintf(buf, size, "%.*s/%.*s",
+                          BUILDING_NAME_ARGS(&building, building.buildings[f->building].name),
+                          BUILDING_NAME_ARGS(&building, f->name));
+     }
+     return snprintf(buf, size, "%.*s", BUILDING_NAME_ARGS(&building, f->name));
+ }
+ 
+ // Copia contagens e andar selecionado sem travar o escritor: se o core0
+ // alterou o estado durante a cópia, ela é refeita
+ static void take_snapshot(occupancy_snapshot_t *s) {
+     uint32_t seq;
+     do {
+          seq = seqlock_read_begin(&state_lock);
+          s->selected = selected_floor;
+          for (int f = 0; f < building.num_floors; f++) s->floor_count[f] = building.floors[f].count;
+          memcpy(s->zone_count, building.zone_count, building.num_zones * sizeof(uint16_t));
+          memcpy(s->alerts_active, alerts.active, sizeof(s->alerts_active));
+     } while (seqlock_read_retry(&state_lock, seq));
+ }
+
+ // Muda o andar selecionado (o chamador atualiza LEDs e telas)
+ static void select_floor(int floor) {
+     seqlock_write_begin(&state_lock);
+     selected_floor = floor;
+     seqlock_write_end(&state_lock);
+     state_version++;
+ }
+
  // Configura o display OLED e os pinos I2C
  void setup_display() {
      i2c_init(I2C_PORT, SSD1306_I2C_CLK);
@@ -139,27 +311,57 @@
      ssd1306_show(&disp);
  }
  
- // Atualiza os LEDs RGB individuais conforme a ocupação do andar selecionado
+ // Atualiza os LEDs RGB individuais: vermelho com o andar selecionado vazio,
+ // azul enquanto houver algum alerta ativo no prédio
  void update_led_status(void) {
-    if (occupancy[selected_floor] == 0) {
+    if (building.floors[selected_floor].count == 0) {
          gpio_put(LED_R_PIN, 1);  // acende o LED vermelho
     } else {
          gpio_put(LED_R_PIN, 0);  // apaga o LED vermelho
     }
-    // Desliga os outros LEDs (verde e azul)
     gpio_put(LED_G_PIN, 0);
-    gpio_put(LED_B_PIN, 0);
+    gpio_put(LED_B_PIN, alerts.num_active > 0);
 }
  
- // Atualiza o display OLED com o status do andar selecionado
- void update_oled_display(void) {
+ // Atualiza o display OLED com o status do andar selecionado: nome, total e
+ // capacidade, o primeiro alerta ativo do andar e, se o andar tiver mais de
+ // uma zona, uma linha por zona
+ void update_oled_display(const occupancy_snapshot_t *s) {
+     int floor = s->selected;
+     const building_floor_t *f = &building.floors[floor];
+     char name[2 * BUILDING_NAME_MAX + 2];
      char buf[64];
      ssd1306_clear(&disp);
-     if (selected_floor == 0)
-          snprintf(buf, sizeof(buf), "Terreo: %d pessoas", occupancy[selected_floor]);
-     else
-          snprintf(buf, sizeof(buf), "Andar %d: %d pessoas", selected_floor, occupancy[selected_floor]);
-     ssd1306_draw_string(&disp, 0, 0, 1, buf);
+     format_floor_name(name, sizeof(name), floor);
+     ssd1306_draw_string(&disp, 0, 0, 1, name);
+     snprintf(buf, sizeof(buf), "%lu/%lu pessoas", (unsigned long)s->floor_count[floor], (unsigned long)f->capacity);
+     ssd1306_draw_string(&disp, 0, 8, 1, buf);
+     int top = 16;
+     int alert = alerts_first_active(&alerts, s->alerts_active, (uint8_t)floor);
+     if (alert >= 0) {
+          // As regras não mudam depois do boot; só o estado vem do snapshot
+          const alert_rule_t *r = &alerts.rules[alert];
+          snprintf(buf, sizeof(buf), "! %s de %u", r->kind == ALERT_ABOVE ? "acima" : "abaixo", r->limit);
+          ssd1306_draw_string(&disp, 0, top, 1, buf);
+          top += 8;
+     }
+     if (f->num_zones > 1) {
+          // Linhas de 8 px abaixo do total; o que não couber vira "+N zonas"
+          int lines = (SSD1306_HEIGHT - top) / 8;
+          int shown = (f->num_zones > lines) ? lines - 1 : f->num_zones;
+          for (int i = 0; i < shown; i++) {
+               uint16_t z = f->first_zone + i;
+               building_name_t zn = building.zone_names[z];
+               if (zn.len > 10) zn.len = 10;  // nome curto para caber a contagem na linha
+               snprintf(buf, sizeof(buf), "%.*s %u/%u", BUILDING_NAME_ARGS(&building, zn),
+                        s->zone_count[z], building.zone_capacity[z]);
+               ssd1306_draw_string(&disp, 0, top + 8 * i, 1, buf);
+          }
+          if (shown < f->num_zones) {
+               snprintf(buf, sizeof(buf), "+%u zonas", (unsigned)(f->num_zones - shown));
+               ssd1306_draw_string(&disp, 0, top + 8 * shown, 1, buf);
+          }
+     }
      ssd1306_show(&disp);
  }
  
@@ -171,194 +373,2403 @@
  // Atualiza a seleção de andar via botões
  void update_floor_selection(void) {
      if (read_button(BUTTON_B)) {
-          selected_floor = (selected_floor + 1) % NUM_FLOORS;
-          update_oled_display();
+          cyw43_arch_lwip_begin();  // serializa com as alterações feitas pelo lwIP
+          select_floor((selected_floor + 1) % building.num_floors);
           update_led_status();
-          update_led_matrix();
+          cyw43_arch_lwip_end();
+          request_render(RENDER_OLED | RENDER_MATRIX);
           sleep_ms(300); // debounce
      }
      if (read_button(BUTTON_A)) {
-          selected_floor = (selected_floor - 1 + NUM_FLOORS) % NUM_FLOORS;
-          update_oled_display();
+          cyw43_arch_lwip_begin();
+          select_floor((selected_floor - 1 + building.num_floors) % building.num_floors);
           update_led_status();
-          update_led_matrix();
+          cyw43_arch_lwip_end();
+          request_render(RENDER_OLED | RENDER_MATRIX);
           sleep_ms(300); // debounce
      }
  }
  
- // Atualiza a ocupação; suporta ações "add", "remove", "clear", "set" e "clear_all"
- // Quando a ação for "set", usa o valor passado em value_str.
- void update_occupancy(const char *floor_str, const char *action, const char *value_str) {
-     if (strcmp(action, "clear_all") == 0) {
-          for (int i = 0; i < NUM_FLOORS; i++) {
-               occupancy[i] = 0;
+ // Ações de ocupação aceitas pela interface web, WebSocket e lote
+ typedef enum {
+     ACTION_NONE = 0,
+     ACTION_ADD,
+     ACTION_REMOVE,
+     ACTION_CLEAR,
+     ACTION_SET,
+     ACTION_CLEAR_ALL,
+     ACTION_CHECKIN,                  // crachá entra na zona (value = ID)
+     ACTION_CHECKOUT,                 // crachá sai (value = ID; andar ignorado)
+ } occupancy_action_t;
+ 
+ static const char *const action_names[] = {
+     [ACTION_ADD]       = "add",
+     [ACTION_REMOVE]    = "remove",
+     [ACTION_CLEAR]     = "clear",
+     [ACTION_SET]       = "set",
+     [ACTION_CLEAR_ALL] = "clear_all",
+     [ACTION_CHECKIN]   = "checkin",
+     [ACTION_CHECKOUT]  = "checkout",
+ };
+ 
+ // Identifica a ação pela primeira letra (e pelo tamanho, no caso de "clear"),
+ // confirmando com uma única comparação de string
+ static occupancy_action_t parse_action(const char *action) {
+     occupancy_action_t act;
+     switch (action[0]) {
+     case 'a': act = ACTION_ADD; break;
+     case 'r': act = ACTION_REMOVE; break;
+     case 's': act = ACTION_SET; break;
+     case 'c':
+          if (action[1] == 'h') act = (strlen(action) == sizeof("checkin") - 1) ? ACTION_CHECKIN : ACTION_CHECKOUT;
+          else act = (strlen(action) > sizeof("clear") - 1) ? ACTION_CLEAR_ALL : ACTION_CLEAR;
+          break;
+     default:  return ACTION_NONE;
+     }
+     return (strcmp(action, action_names[act]) == 0) ? act : ACTION_NONE;
+ }
+ 
+ // Converte um número decimal sem sinal de 0 a max. Rejeita texto vazio,
+ // caracteres não numéricos e valores fora da faixa.
+ static bool parse_uint(const char *s, int max, int *out) {
+     if (!isdigit((unsigned char)*s)) return false;
+     int n = 0;
+     for (; isdigit((unsigned char)*s); s++) {
+          int d = *s - '0';
+          if (n > (max - d) / 10) return false;  // n * 10 + d > max, sem overflow
+          n = n * 10 + d;
+     }
+     if (*s != '\0') return false;
+     *out = n;
+     return true;
+ }
+ 
+ // Converte o alvo de uma ação: "andar" ou "andar.zona" (zona dentro do
+ // andar, a partir de 0). Sem zona, *zone recebe -1.
+ static bool parse_target(const char *s, int *floor, int *zone) {
+     char floor_str[4];
+     const char *dot = strchr(s, '.');
+     size_t n = dot ? (size_t)(dot - s) : strlen(s);
+     if (n >= sizeof(floor_str)) return false;
+     memcpy(floor_str, s, n);
+     floor_str[n] = '\0';
+     if (!parse_uint(floor_str, building.num_floors - 1, floor)) return false;
+     *zone = -1;
+     return !dot || parse_uint(dot + 1, building.floors[*floor].num_zones - 1, zone);
+ }
+ 
+ // Segundos desde o boot. to_ms_since_boot é de 32 bits e volta a zero em
+ // ~49,7 dias, o que congelaria as séries; em segundos, 32 bits duram 136 anos
+ static uint32_t uptime_s(void) {
+     return (uint32_t)(time_us_64() / 1000000);
+ }
+ 
+ // Define a contagem de uma zona e registra a variação efetiva (já limitada
+ // à capacidade) no histórico, na fila de gravação da flash e na série do
+ // andar; as regras de alerta do andar são reavaliadas com o novo total
+ static void set_zone(uint16_t zone, int32_t value, event_source_t source) {
+     int32_t before = building.zone_count[zone];
+     int32_t delta = (int32_t)building_zone_set(&building, zone, value) - before;
+     if (delta != 0) {
+          uint32_t now_s = uptime_s();
+          uint8_t floor = building.zone_floor[zone];
+          event_log_append(&checkin_log, now_s, zone, delta, source);
+          uint16_t anonymous = building.zone_count[zone] - zone_badges[zone];
+          if (anonymous != zone_saved[zone]) {
+               zone_saved[zone] = anonymous;
+               flash_store_record(&occupancy_store, zone, anonymous);
           }
-     } else {
-          int floor = atoi(floor_str);
-          if (floor < 0 || floor >= NUM_FLOORS) return;
-          selected_floor = floor;
-          if (strcmp(action, "add") == 0) {
-               if (occupancy[floor] < MAX_OCCUPANCY)
-                    occupancy[floor]++;
-          } else if (strcmp(action, "remove") == 0) {
-               if (occupancy[floor] > 0)
-                    occupancy[floor]--;
-          } else if (strcmp(action, "clear") == 0) {
-               occupancy[floor] = 0;
-          } else if (strcmp(action, "set") == 0) {
-               occupancy[floor] = atoi(value_str);
-          }
-     }
-     printf("Andar %d: nova ocupacao = %d\n", selected_floor, occupancy[selected_floor]);
+          timeseries_set(&occupancy_series, floor, now_s, building.floors[floor].count);
+          minute_index_set(&minute_index, floor, now_s, building.floors[floor].count);
+          alerts_update(&alerts, floor, building.floors[floor].count, now_s);
+     }
+ }
+ 
+ // Retira da tabela os crachás das zonas [first, first + count)
+ static void clear_badges(uint16_t first, uint16_t count) {
+     uint32_t n = 0;
+     for (uint16_t z = first; z < first + count; z++) n += zone_badges[z];
+     if (n == 0) return;  // nada a procurar na tabela
+     presence_remove_zones(&presence, first, count);
+     memset(&zone_badges[first], 0, count * sizeof(zone_badges[0]));
+ }
+ 
+ // Zera as zonas [first, first + count) e os crachás nelas, com um registro
+ // por zona que mudou
+ static void clear_zones(uint16_t first, uint16_t count, event_source_t source) {
+     clear_badges(first, count);
+     for (uint16_t z = first; z < first + count; z++) {
+          if (building.zone_count[z] != 0) set_zone(z, 0, source);
+     }
+ }
+ 
+ // Minutos desde o boot, módulo 2^16 (presence.c compara por diferença). Vem
+ // do timer de 64 bits: os ms de 32 bits voltariam a zero no meio de um minuto
+ // de 16 bits e todos os crachás pareceriam vencidos de uma vez
+ static uint16_t now_minutes(void) {
+     return (uint16_t)(time_us_64() / 60000000);
+ }
+
+ // Entrada ou troca de zona de um crachá. A contagem das zonas acompanha a
+ // tabela: uma segunda leitura na mesma zona só renova o instante. Recusa se a
+ // zona estiver lotada (a contagem não acompanharia) ou a tabela cheia.
+ static bool badge_checkin(uint32_t id, uint16_t zone, event_source_t source) {
+     uint16_t old_zone;
+     bool here = presence_lookup(&presence, id, &old_zone) && old_zone == zone;
+     if (!here && building.zone_count[zone] >= building.zone_capacity[zone]) return false;
+     switch (presence_checkin(&presence, id, zone, now_minutes(), &old_zone)) {
+     case PRESENCE_MOVED:
+          zone_badges[old_zone]--;
+          set_zone(old_zone, (int32_t)building.zone_count[old_zone] - 1, source);
+          // fall through
+     case PRESENCE_ENTERED:
+          zone_badges[zone]++;
+          set_zone(zone, (int32_t)building.zone_count[zone] + 1, source);
+          return true;
+     case PRESENCE_REFRESHED:
+          return true;
+     default:
+          return false;
+     }
+ }
+
+ // Saída de um crachá; false se ele não estava presente
+ static bool badge_checkout(uint32_t id, event_source_t source) {
+     uint16_t zone;
+     if (presence_checkout(&presence, id, &zone) != PRESENCE_LEFT) return false;
+     zone_badges[zone]--;
+     set_zone(zone, (int32_t)building.zone_count[zone] - 1, source);
+     return true;
+ }
+
+ // Aplica uma ação ao modelo. Sem zona (zone = -1), "clear" zera o andar
+ // inteiro e as demais ações valem para a primeira zona do andar.
+ // "add"/"remove" somam/subtraem value pessoas e "set" define o total, sempre
+ // limitado a 0..capacidade da zona; "checkin"/"checkout" recebem o crachá em
+ // value. "clear"/"clear_all" também retiram os crachás das zonas zeradas, e
+ // "remove"/"set" são recusados se deixariam a zona com menos pessoas que
+ // crachás presentes (não há como saber quais saíram). Retorna false se o
+ // alvo for inválido ou a ação for recusada.
+ static bool apply_action(int floor, int zone, occupancy_action_t action, int value, event_source_t source) {
+     if (action == ACTION_CLEAR_ALL) {
+          clear_zones(0, building.num_zones, source);
+          presence_init(&presence, PRESENCE_TTL_MIN);
+          return true;
+     }
+     if (action == ACTION_CHECKOUT) return badge_checkout((uint32_t)value, source);
+     int z = building_zone_index(&building, floor, zone < 0 ? 0 : zone);
+     if (z < 0) return false;
+     switch (action) {
+     case ACTION_ADD:
+          set_zone((uint16_t)z, (int32_t)building.zone_count[z] + value, source);
+          break;
+     case ACTION_REMOVE:
+          if ((int32_t)building.zone_count[z] - value < (int32_t)zone_badges[z]) return false;
+          set_zone((uint16_t)z, (int32_t)building.zone_count[z] - value, source);
+          break;
+     case ACTION_CLEAR:
+          if (zone < 0) clear_zones(building.floors[floor].first_zone, building.floors[floor].num_zones, source);
+          else clear_zones((uint16_t)z, 1, source);
+          break;
+     case ACTION_SET:
+          if (value < (int)zone_badges[z]) return false;
+          set_zone((uint16_t)z, value, source);
+          break;
+     case ACTION_CHECKIN:
+          return badge_checkin((uint32_t)value, (uint16_t)z, source);
+     default:
+          break;
+     }
+     return true;
+ }
+ 
+ // Publica as alterações já aplicadas ao modelo: nova versão, eventos dos
+ // andares e alertas que mudaram, os LEDs e um único pedido de redesenho ao core1
+ static void commit_occupancy(void) {
+     state_version++;
+     // Notifica os assinantes (/events e /ws) apenas dos andares que mudaram
+     int floor;
+     while ((floor = building_next_dirty(&building)) >= 0) publish_floor(floor);
+     publish_alerts();
+     printf("Andar %d: nova ocupacao = %lu\n", selected_floor,
+            (unsigned long)building.floors[selected_floor].count);
      update_led_status();
-     update_oled_display();
-     update_led_matrix();
+     request_render(RENDER_OLED | RENDER_MATRIX);
  }
  
- /* Função para extrair parâmetros da query string.
-    Extrai os parâmetros "floor", "action" e "value". */
- static void parse_query_params(const char *request_line, char *floor_str, size_t floor_len,
-                                  char *action, size_t action_len, char *value_str, size_t value_len) {
-     parse_param(request_line, "floor=", floor_str, floor_len);
-     parse_param(request_line, "action=", action, action_len);
-     parse_param(request_line, "value=", value_str, value_len);
+ // Atualiza a ocupação; suporta ações "add", "remove", "clear", "set", "clear_all",
+ // "checkin" e "checkout". value é a quantidade de pessoas ("add"/"remove"), o
+ // novo total ("set") ou o crachá; zone é a zona dentro do andar, ou -1 (ver
+ // apply_action); source vai para o histórico. Retorna false se a ação foi recusada.
+ bool update_occupancy(int floor, int zone, occupancy_action_t act, int value, event_source_t source) {
+     if (act == ACTION_NONE) return false;
+     bool any_floor = (act == ACTION_CLEAR_ALL || act == ACTION_CHECKOUT);
+     if (!any_floor && building_zone_index(&building, floor, zone < 0 ? 0 : zone) < 0) return false;
+     seqlock_write_begin(&state_lock);
+     if (!any_floor) selected_floor = floor;
+     bool ok = apply_action(floor, zone, act, value, source);
+     seqlock_write_end(&state_lock);
+     commit_occupancy();
+     return ok;
+ }
+
+ // Remove os crachás vencidos (PRESENCE_TTL_MIN sem nova leitura) aos poucos,
+ // descontando cada um da sua zona
+ static void expire_badges(void) {
+     presence_entry_t e;
+     bool changed = false;
+     while (presence_expire(&presence, now_minutes(), PRESENCE_SWEEP_SLOTS, &e)) {
+          seqlock_write_begin(&state_lock);
+          zone_badges[e.zone]--;
+          set_zone(e.zone, (int32_t)building.zone_count[e.zone] - 1, EVENT_SOURCE_EXPIRE);
+          seqlock_write_end(&state_lock);
+          changed = true;
+     }
+     if (changed) commit_occupancy();
+ }
+
+ // Dispara os alertas cujo tempo mínimo venceu sem nova alteração do andar
+ static void check_alert_deadlines(void) {
+     seqlock_write_begin(&state_lock);
+     bool changed = alerts_poll(&alerts, uptime_s());
+     seqlock_write_end(&state_lock);
+     if (!changed) return;
+     state_version++;
+     publish_alerts();
+     update_led_status();
+     request_render(RENDER_OLED);
  }
  
  /* ─── GERA A PÁGINA HTML ───────────────────────────────────────────── */
- void create_html_page(char *buffer, size_t buffer_size) {
-     char body[2048] = "";
-     strcat(body, "<!DOCTYPE html><html><head><meta charset=\"UTF-8\"><title>Monitor de Ocupacao</title>");
-     strcat(body, "<style>table, th, td { border: 1px solid black; border-collapse: collapse; padding: 8px; }</style>");
-     strcat(body, "<meta http-equiv=\"Cache-Control\" content=\"no-store\"/>");
-     strcat(body, "</head><body>");
-     strcat(body, "<h1>Monitor de Ocupacao do Predio</h1>");
+ // Fragmentos constantes da página. Ficam na flash (XIP) e são enfileirados no
+ // lwIP sem cópia; as opções e as linhas da tabela vêm de um cache regenerado só
+ // quando o estado muda, e são enviadas aos pedaços conforme o buffer de envio
+ // libera espaço (ver http_stream_page).
+ static const char HTML_HEADER[] =
+     "<!DOCTYPE html><html><head><meta charset=\"UTF-8\"><title>Monitor de Ocupacao</title>"
+     "<style>table, th, td { border: 1px solid black; border-collapse: collapse; padding: 8px; }</style>"
+     "<meta http-equiv=\"Cache-Control\" content=\"no-store\"/>"
+     "</head><body>"
+     "<h1>Monitor de Ocupacao do Predio</h1>"
+     "<form action=\"/\" method=\"GET\">"
+     "<label for=\"floor\">Selecione o Andar:</label>"
+     "<select name=\"floor\" id=\"floor\">";
+ 
+ static const char HTML_FORM[] =
+     "</select> "
+     "<label for=\"zone\">Zona:</label> "
+     "<input type=\"text\" name=\"zone\" id=\"zone\" size=\"3\" placeholder=\"0\"><br/><br/>"
+     "<input type=\"submit\" name=\"action\" value=\"add\"> "
+     "<input type=\"submit\" name=\"action\" value=\"remove\"> "
+     "<input type=\"submit\" name=\"action\" value=\"clear\"> "
+     "<input type=\"submit\" name=\"action\" value=\"clear_all\"> <br/><br/>"
+     "Ou defina a ocupacao: <input type=\"text\" name=\"value\" placeholder=\"Numero\"> "
+     "<input type=\"submit\" name=\"action\" value=\"set\"><br/><br/>"
+     "<label for=\"badge\">Cracha:</label> <input type=\"text\" name=\"badge\" id=\"badge\" placeholder=\"ID\"> "
+     "<input type=\"submit\" name=\"action\" value=\"checkin\"> "
+     "<input type=\"submit\" name=\"action\" value=\"checkout\">"
+     "</form>"
+     "<h2>Status dos Andares</h2>"
+     "<table>"
+     "<tr><th>Andar</th><th>Ocupacao</th><th>Capacidade</th></tr>";
+ 
+ static const char HTML_FOOTER[] = "</table></body></html>";
+ 
+ // Acrescenta texto formatado ao buffer na posição *pos, sem ultrapassar o tamanho
+ static void page_append(char *buffer, size_t buffer_size, size_t *pos, const char *fmt, ...) {
+     if (*pos >= buffer_size) return;
+     va_list args;
+     va_start(args, fmt);
+     int n = vsnprintf(buffer + *pos, buffer_size - *pos, fmt, args);
+     va_end(args);
+     if (n > 0) {
+          *pos += (size_t)n;
+          if (*pos >= buffer_size) *pos = buffer_size - 1;  // truncado
+     }
+ }
+ 
+ // Partes da página, na ordem de envio
+ typedef enum {
+     PAGE_HEADER = 0,
+     PAGE_OPTIONS,                    // <option> de cada andar
+     PAGE_FORM,
+     PAGE_ROWS,                       // <tr> de cada andar e zona
+     PAGE_FOOTER,
+     PAGE_END,                        // chunk final (tamanho zero)
+     PAGE_DONE,
+ } page_section_t;
+ 
+ // Posição do gerador dentro da página; é tudo o que precisa ser guardado
+ // entre um pedaço e outro, qualquer que seja o número de andares
+ typedef struct {
+     bool active;                     // página sendo enviada
+     u8_t section;                    // page_section_t
+     bool chunked;                    // Transfer-Encoding: chunked (HTTP/1.1)
+     u16_t item;                      // próximo andar (opções) ou zona (tabela)
+     u16_t offset;                    // bytes já enviados do fragmento constante
+ } page_stream_t;
+ 
+ // Fragmento constante da seção (NULL nas seções geradas)
+ static const char *page_section_text(u8_t section, size_t *len) {
+     switch (section) {
+     case PAGE_HEADER: *len = sizeof(HTML_HEADER) - 1; return HTML_HEADER;
+     case PAGE_FORM:   *len = sizeof(HTML_FORM) - 1;   return HTML_FORM;
+     case PAGE_FOOTER: *len = sizeof(HTML_FOOTER) - 1; return HTML_FOOTER;
+     default:          *len = 0;                       return NULL;
+     }
+ }
+ 
+ // Formata a opção do formulário de um andar ou as linhas da tabela de uma
+ // zona; a primeira zona de cada andar traz antes a linha com o total do andar,
+ // e andares de uma só zona não repetem a zona
+ static int page_format_item(char *buf, size_t size, u8_t section, int item) {
+     char name[2 * BUILDING_NAME_MAX + 2];
+     if (section == PAGE_OPTIONS) {
+          format_floor_name(name, sizeof(name), item);
+          return snprintf(buf, size, "<option value=\"%d\" %s>%s</option>",
+                          item, (item == selected_floor) ? "selected" : "", name);
+     }
+     int floor = building.zone_floor[item];
+     const building_floor_t *f = &building.floors[floor];
+     int n = 0;
+     if (item == f->first_zone) {
+          format_floor_name(name, sizeof(name), floor);
+          n = snprintf(buf, size, "<tr><td>%s</td><td>%lu pessoas</td><td>%lu</td></tr>",
+                       name, (unsigned long)f->count, (unsigned long)f->capacity);
+          if (n < 0 || (size_t)n >= size) return n;
+     }
+     if (f->num_zones > 1) {
+          int z = snprintf(buf + n, size - (size_t)n,
+                           "<tr><td>&nbsp;&nbsp;%d.%d %.*s</td><td>%u pessoas</td><td>%u</td></tr>",
+                           floor, item - f->first_zone, BUILDING_NAME_ARGS(&building, building.zone_names[item]),
+                           building.zone_count[item], building.zone_capacity[item]);
+          if (z < 0) return z;
+          n += z;
+     }
+     return n;
+ }
+ 
+ // Pedaço de página gerado em RAM para os itens que não couberam no cache. É
+ // compartilhado entre as conexões porque o altcp_write com TCP_WRITE_FLAG_COPY
+ // copia os dados na hora.
+ static char page_chunk[PAGE_CHUNK_MAX];
+ 
+ // Cache das partes dinâmicas da página, item a item (opções dos andares e
+ // depois as zonas), e a versão do estado a que corresponde. Os pedaços são
+ // enviados direto daqui; com muitos andares, os itens além de PAGE_CACHE_MAX
+ // são formatados a cada envio em page_chunk.
+ static struct {
+     uint32_t version;                // 0 = ainda não gerado
+     u16_t items;                     // itens em cache
+     u16_t end[BUILDING_MAX_FLOORS + BUILDING_MAX_ZONES];  // fim de cada item em text
+     char text[PAGE_CACHE_MAX];
+ } page_cache;
+ _Static_assert(PAGE_CACHE_MAX <= UINT16_MAX, "page_cache.end usa u16_t");
+ 
+ // Regenera o cache apenas se o estado mudou desde a última geração
+ static void page_cache_refresh(void) {
+     if (page_cache.version == state_version) return;
+     u16_t total = (u16_t)(building.num_floors + building.num_zones);
+     size_t pos = 0;
+     page_cache.items = 0;
+     for (u16_t i = 0; i < total; i++) {
+          bool option = i < building.num_floors;
+          int n = page_format_item(page_cache.text + pos, sizeof(page_cache.text) - pos,
+                                   option ? PAGE_OPTIONS : PAGE_ROWS, option ? i : i - building.num_floors);
+          if (n < 0 || (size_t)n >= sizeof(page_cache.text) - pos) break;
+          pos += (size_t)n;
+          page_cache.end[page_cache.items++] = (u16_t)pos;
+     }
+     page_cache.version = state_version;
+ }
+ 
+ // Entrega quantos itens inteiros da seção dinâmica couberem em size e avança o
+ // gerador; ao terminar os andares (ou zonas) passa para a próxima seção. O
+ // gerador guarda o índice do item, não a posição no texto, então uma conexão
+ // que estava no meio da página continua certa depois de o cache ser regenerado.
+ static const char *page_fill_items(page_stream_t *st, size_t size, size_t *len) {
+     u16_t count = (st->section == PAGE_OPTIONS) ? building.num_floors : building.num_zones;
+     u16_t base = (st->section == PAGE_OPTIONS) ? 0 : building.num_floors;
+     const char *data = page_chunk;
+     size_t pos = 0;
+     page_cache_refresh();
+     if (st->item < count && base + st->item < page_cache.items) {
+          size_t start = (base + st->item == 0) ? 0 : page_cache.end[base + st->item - 1];
+          data = page_cache.text + start;
+          while (st->item < count && base + st->item < page_cache.items &&
+                 page_cache.end[base + st->item] - start <= size) {
+               pos = page_cache.end[base + st->item] - start;
+               st->item++;
+          }
+     } else {
+          while (st->item < count) {
+               int n = page_format_item(page_chunk + pos, size - pos, st->section, st->item);
+               if (n < 0 || (size_t)n >= size - pos) break;  // não coube: vai no próximo pedaço
+               pos += (size_t)n;
+               st->item++;
+          }
+     }
+     if (st->item >= count) {
+          st->section++;
+          st->item = 0;
+     }
+     *len = pos;
+     return data;
+ }
+ 
+ /* ─── FUNÇÕES DO SERVIDOR HTTP ───────────────────────────────────────── */
+ // Trecho da resposta a ser enfileirado com altcp_write. Fragmentos constantes
+ // (flash) usam flags = 0 e são referenciados sem cópia; os dinâmicos usam
+ // TCP_WRITE_FLAG_COPY, pois o buffer de origem pode mudar antes do ACK.
+ typedef struct {
+     const char *data;
+     size_t len;
+     u8_t flags;
+ } http_fragment_t;
+ 
+ // Enfileira todos os fragmentos de uma resposta. Retorna o primeiro erro do lwIP.
+ static err_t http_write_fragments(struct altcp_pcb *tpcb, const http_fragment_t *frags, size_t count) {
+     for (size_t i = 0; i < count; i++) {
+          if (frags[i].len == 0) continue;
+          u8_t flags = frags[i].flags;
+          if (i + 1 < count) flags |= TCP_WRITE_FLAG_MORE;
+          err_t err = altcp_write(tpcb, frags[i].data, frags[i].len, flags);
+          if (err != ERR_OK) return err;
+     }
+     return ERR_OK;
+ }
+ 
+ // PCB TCP no fim da cadeia altcp (o altcp_tcp guarda o tcp_pcb em state), para
+ // as funções de backlog do listener, que o altcp não repassa
+ static struct tcp_pcb *http_tcp_pcb(struct altcp_pcb *pcb) {
+     while (pcb->inner_conn) pcb = pcb->inner_conn;
+     return (struct tcp_pcb *)pcb->state;
+ }
+ 
+ // Modo de uma conexão: requisições HTTP comuns ou assinante de eventos
+ typedef enum {
+     CONN_HTTP = 0,
+     CONN_SSE,                        // /events: só recebe eventos
+     CONN_WS,                         // /ws: frames nos dois sentidos
+ } conn_mode_t;
+ 
+ // Operação de um lote, já validada durante a leitura do corpo
+ typedef struct {
+     u8_t floor;
+     u8_t action;                     // occupancy_action_t
+     int16_t zone;                    // -1 = andar inteiro / primeira zona
+     int32_t value;                   // pessoas, novo total ou crachá
+     u16_t line;                      // linha do corpo (para a mensagem de erro)
+ } batch_op_t;
+ 
+ // Leitura incremental do corpo de POST /api/batch. As operações ficam
+ // guardadas e só são aplicadas, todas juntas, quando o corpo termina.
+ typedef struct {
+     bool active;                     // corpo em leitura
+     u32_t remaining;                 // bytes do corpo ainda não lidos
+     char line[BATCH_LINE_MAX];
+     u8_t line_len;
+     batch_op_t ops[BATCH_MAX_OPS];
+     u8_t num_ops;
+     u16_t lines;                     // linhas lidas (para a mensagem de erro)
+     u16_t error_line;                // 0 = sem erro
+     bool too_many;
+ } batch_state_t;
+ 
+ // Estado de uma conexão HTTP persistente (keep-alive)
+ typedef struct {
+     struct altcp_pcb *pcb;             // NULL = posição livre
+     struct pbuf *pending;            // dados recebidos ainda não consumidos
+     union {
+          http_parser_t parser;       // CONN_HTTP: requisição em andamento
+          ws_parser_t ws;             // CONN_WS: frame em andamento
+     };
+     u8_t mode;                       // conn_mode_t
+     batch_state_t batch;             // corpo de POST /api/batch (ou /api/config)
+     u16_t requests;                  // requisições atendidas nesta conexão
+     u16_t idle_ticks;                // chamadas de altcp_poll sem atividade
+     u16_t stall_ticks;               // chamadas de altcp_poll com dados sem ACK
+     u32_t unacked;                   // bytes enfileirados ainda sem ACK
+     bool close_after_send;           // fecha quando tudo for confirmado
+     err_t close_err;                 // resultado do fechamento por subscriber_send (ERR_ABRT: PCB abortado)
+     bool in_backlog;                 // ainda conta no backlog do listener
+     u8_t client;                     // balde de rate limit do IP (ver rate_limit_slot)
+     page_stream_t page;              // GET /: página em envio
+     bool tls;                        // aceita pelo listener HTTPS
+ #if HTTPS_ENABLED
+     tls_server_conn_t tls_state;     // medição do handshake (ver tls_server.h)
+ #endif
+ } http_conn_t;
+ 
+ static http_conn_t http_conns[HTTP_MAX_CONNECTIONS];
+ 
+ // Rotas do servidor (ver http_routes e http_resolve_route)
+ #define ROUTE_PATH_PAGE     "/"
+ #define ROUTE_PATH_APP      "/app"
+ #define ROUTE_PATH_APP_JS   "/app/" WEB_APP_VERSION ".js"
+ #define ROUTE_PATH_FLOORS   "/api/floors"
+ #define ROUTE_PATH_BATCH    "/api/batch"
+ #define ROUTE_PATH_EVENTS   "/events"
+ #define ROUTE_PATH_WS       "/ws"
+ #define ROUTE_PATH_TLS      "/api/tls"
+ #define ROUTE_PATH_CHECKINS "/api/checkins"
+ #define ROUTE_PATH_SERIES   "/api/timeseries"
+ #define ROUTE_PATH_OCCUPANCY "/api/occupancy"
+ #define ROUTE_PATH_CONFIG   "/api/config"
+ 
+ // Testes de conectividade dos sistemas (portal cativo)
+ #define ROUTE_PATH_PROBE_GENERATE_204   "/generate_204"               // Android
+ #define ROUTE_PATH_PROBE_GEN_204        "/gen_204"                    // Android
+ #define ROUTE_PATH_PROBE_HOTSPOT        "/hotspot-detect.html"        // Apple
+ #define ROUTE_PATH_PROBE_APPLE_SUCCESS  "/library/test/success.html"  // Apple
+ #define ROUTE_PATH_PROBE_CONNECTTEST    "/connecttest.txt"            // Windows 10+
+ #define ROUTE_PATH_PROBE_NCSI           "/ncsi.txt"                   // Windows
+ #define ROUTE_PATH_PROBE_REDIRECT       "/redirect"                   // Windows
+ #define ROUTE_PATH_PROBE_SUCCESS_TXT    "/success.txt"                // Firefox
+ 
+ typedef enum {
+     ROUTE_UNRESOLVED = 0,
+     ROUTE_PAGE,
+     ROUTE_APP,
+     ROUTE_APP_JS,
+     ROUTE_FLOORS,
+     ROUTE_BATCH,
+     ROUTE_EVENTS,
+     ROUTE_WS,
+     ROUTE_TLS,
+     ROUTE_CHECKINS,
+     ROUTE_SERIES,
+     ROUTE_OCCUPANCY,
+     ROUTE_CONFIG,
+     ROUTE_PROBE_GENERATE_204,
+     ROUTE_PROBE_GEN_204,
+     ROUTE_PROBE_HOTSPOT,
+     ROUTE_PROBE_APPLE_SUCCESS,
+     ROUTE_PROBE_CONNECTTEST,
+     ROUTE_PROBE_NCSI,
+     ROUTE_PROBE_REDIRECT,
+     ROUTE_PROBE_SUCCESS_TXT,
+     ROUTE_NOT_FOUND,                 // nenhum caminho conhecido
+     ROUTE_COUNT,
+ } http_route_id_t;
+ 
+ // Parâmetros da query string já convertidos para os handlers
+ #define ARG_FLOOR    0x01             // floor=0..num_floors-1
+ #define ARG_ACTION   0x02             // action=add|remove|clear|set|clear_all
+ #define ARG_VALUE    0x04             // value=0..32767
+ #define ARG_ZONE     0x08             // zone=zona dentro do andar (validada em apply_action)
+ #define ARG_CURSOR   0x10             // cursor=sequência do histórico
+ #define ARG_LIMIT    0x20             // limit=1..CHECKINS_PAGE_MAX
+ #define ARG_RES      0x40             // res=minute|hour|day
+ #define ARG_FROM     0x80             // from=segundos desde o boot
+ #define ARG_TO       0x100            // to=segundos desde o boot
+ #define ARG_BADGE    0x200            // badge=ID do crachá (1..2147483647)
+ 
+ /* ─── LIMITE DE REQUISIÇÕES POR CLIENTE ─────────────────────────────── */
+ // Um balde por endereço que o servidor DHCP pode entregar (DHCPS_BASE_IP em
+ // diante), um compartilhado pelos demais IPv4 (IP fixo configurado no
+ // cliente) e, com IPv6, alguns escolhidos por hash do endereço do cliente.
+ // Os créditos ficam em milésimos de requisição para repor sem divisão.
+ #define RATE_LIMIT_OTHER    DHCPS_MAX_IP
+ #if LWIP_IPV6
+ #define RATE_LIMIT_V6_SLOTS 4
+ #else
+ #define RATE_LIMIT_V6_SLOTS 0
+ #endif
+ #define RATE_LIMIT_SLOTS    (DHCPS_MAX_IP + 1 + RATE_LIMIT_V6_SLOTS)
+ 
+ typedef struct {
+     u32_t credits;                   // em milésimos de requisição
+     u32_t last_ms;                   // última reposição
+ } rate_bucket_t;
+ 
+ static rate_bucket_t rate_buckets[RATE_LIMIT_SLOTS];
+ 
+ // Balde correspondente ao IP do cliente
+ static u8_t rate_limit_slot(const ip_addr_t *addr) {
+ #if LWIP_IPV6
+     // O listener aceita IPv6 (IPADDR_TYPE_ANY): o último byte IPv4 não existe
+     if (IP_IS_V6(addr)) {
+          const u32_t *w = ip_2_ip6(addr)->addr;
+          u32_t h = (w[0] ^ w[1] ^ w[2] ^ w[3]) * 2654435761u;  // hash de Fibonacci
+          return (u8_t)(RATE_LIMIT_OTHER + 1 + (h >> 24) % RATE_LIMIT_V6_SLOTS);
+     }
+ #endif
+     u8_t host = ip4_addr4(ip_2_ip4(addr));
+     if (host >= DHCPS_BASE_IP && host < DHCPS_BASE_IP + DHCPS_MAX_IP) return host - DHCPS_BASE_IP;
+     return RATE_LIMIT_OTHER;
+ }
+ 
+ // Repõe os créditos pelo tempo decorrido e desconta o custo da requisição.
+ // Retorna false se o cliente já gastou o que tinha.
+ static bool rate_limit_take(u8_t slot, u8_t cost) {
+     rate_bucket_t *b = &rate_buckets[slot];
+     u32_t now = to_ms_since_boot(get_absolute_time());
+     u32_t elapsed = now - b->last_ms;
+     b->last_ms = now;
+     if (elapsed > RATE_LIMIT_BURST * 1000 / RATE_LIMIT_PER_SEC) {
+          b->credits = RATE_LIMIT_BURST * 1000;   // ficou parado tempo suficiente para encher
+     } else {
+          b->credits += elapsed * RATE_LIMIT_PER_SEC;
+          if (b->credits > RATE_LIMIT_BURST * 1000) b->credits = RATE_LIMIT_BURST * 1000;
+     }
+     if (b->credits < (u32_t)cost * 1000) return false;
+     b->credits -= (u32_t)cost * 1000;
+     return true;
+ }
+ 
+ typedef struct {
+     u16_t present;                   // ARG_* válidos na requisição
+     int floor;                       // 0 se ausente
+     int zone;                        // -1 se ausente
+     occupancy_action_t action;
+     int value;                       // 0 se ausente
+     int cursor;                      // 0 se ausente
+     int limit;                       // 0 se ausente
+     timeseries_level_t res;          // TIMESERIES_MINUTE se ausente
+     int from;                        // 0 se ausente
+     int to;                          // 0 se ausente
+     int badge;                       // 0 se ausente
+ } http_args_t;
+ 
+ static const char HTTP_405_RESPONSE[] =
+     "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, POST\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ static const char HTTP_411_RESPONSE[] =
+     "HTTP/1.1 411 Length Required\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ static const char HTTP_413_RESPONSE[] =
+     "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ static const char HTTP_503_RESPONSE[] =
+     "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 10\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ static const char SSE_HEAD[] =
+     "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+     "Connection: keep-alive\r\n\r\nretry: 3000\n\n";
+ static const char SSE_HEARTBEAT[] = ": ping\n\n";
+ static const char SSE_FLOOR_PREFIX[] = "event: floor\ndata: ";
+ static const char SSE_ALERT_PREFIX[] = "event: alert\ndata: ";
+ static const char SSE_EVENT_END[] = "\n\n";
+ static const char WS_PING_FRAME[] = { (char)0x89, 0x00 };
+ static const char HTTP_426_RESPONSE[] =
+     "HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ static const char HTTP_400_RESPONSE[] =
+     "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ static const char HTTP_414_RESPONSE[] =
+     "HTTP/1.1 414 URI Too Long\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ // Sem "Connection": o cliente pode continuar na mesma conexão depois de esperar
+ static const char HTTP_429_RESPONSE[] =
+     "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 1\r\nContent-Length: 0\r\n\r\n";
+ 
+ // Respostas do portal cativo, completas e constantes na flash. Sem "Connection":
+ // a conexão segue as regras normais de keep-alive.
+ static const char PROBE_204_RESPONSE[] =
+     "HTTP/1.1 204 No Content\r\nContent-Length: 0\r\n\r\n";
+ static const char PROBE_APPLE_RESPONSE[] =
+     "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: 68\r\n\r\n"
+     "<HTML><HEAD><TITLE>Success</TITLE></HEAD><BODY>Success</BODY></HTML>";
+ static const char PROBE_CONNECTTEST_RESPONSE[] =
+     "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 22\r\n\r\n"
+     "Microsoft Connect Test";
+ static const char PROBE_NCSI_RESPONSE[] =
+     "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 14\r\n\r\n"
+     "Microsoft NCSI";
+ static const char PROBE_SUCCESS_TXT_RESPONSE[] =
+     "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 8\r\n\r\n"
+     "success\n";
+ static const char PORTAL_REDIRECT_RESPONSE[] =
+     "HTTP/1.1 302 Found\r\nLocation: http://" PORTAL_HOST "/\r\nContent-Length: 0\r\n\r\n";
+ static const char HTTP_431_RESPONSE[] =
+     "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ // Caminho desconhecido: curta, sem "Connection", para não derrubar o keep-alive
+ static const char HTTP_404_RESPONSE[] =
+     "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n\r\nnot found\n";
+ static const char HTTP_404_CLOSE_RESPONSE[] =
+     "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+ 
+ static err_t http_process_requests(http_conn_t *conn);
+ static err_t http_send_error(http_conn_t *conn);
+ 
+ // Libera a posição do pool e fecha a conexão. Retorna ERR_ABRT se foi preciso
+ // abortar o PCB (valor que deve ser repassado ao lwIP pela callback).
+ static err_t http_conn_close(http_conn_t *conn) {
+     struct altcp_pcb *tpcb = conn->pcb;
+     conn->pcb = NULL;
+ #if HTTPS_ENABLED
+     if (conn->tls) tls_server_closed(&conn->tls_state);
+ #endif
+     if (conn->pending) {
+          pbuf_free(conn->pending);
+          conn->pending = NULL;
+     }
+     altcp_arg(tpcb, NULL);
+     altcp_recv(tpcb, NULL);
+     altcp_sent(tpcb, NULL);
+     altcp_poll(tpcb, NULL, 0);
+     altcp_err(tpcb, NULL);
+     err_t err = altcp_close(tpcb);
+     if (err != ERR_OK) {
+          printf("Erro ao fechar conexao (err=%d), abortando.\n", err);
+          altcp_abort(tpcb);
+          return ERR_ABRT;
+     }
+     return ERR_OK;
+ }
+ 
+ // JSON do estado gerado em RAM. Compartilhado pelas respostas porque o
+ // altcp_write com TCP_WRITE_FLAG_COPY copia os dados na hora.
+ static char state_json[STATE_JSON_MAX];
+ 
+ // Campos do estado em JSON: versão, andar selecionado e contagem de cada
+ // andar; com full, também capacidade e nome (que não mudam durante a execução)
+ static void append_state_fields(char *buf, size_t size, size_t *pos, bool full) {
+     size_t len = *pos;
+     page_append(buf, size, &len, "\"v\":%lu,\"selected\":%d,\"floors\":[",
+                 (unsigned long)state_version, selected_floor);
+     for (int i = 0; i < building.num_floors; i++) {
+          page_append(buf, size, &len, i ? ",%lu" : "%lu", (unsigned long)building.floors[i].count);
+     }
+     if (full) {
+          page_append(buf, size, &len, "],\"capacity\":[");
+          for (int i = 0; i < building.num_floors; i++) {
+               page_append(buf, size, &len, i ? ",%lu" : "%lu", (unsigned long)building.floors[i].capacity);
+          }
+          page_append(buf, size, &len, "],\"names\":[");
+          for (int i = 0; i < building.num_floors; i++) {
+               char name[2 * BUILDING_NAME_MAX + 2];
+               format_floor_name(name, sizeof(name), i);
+               page_append(buf, size, &len, i ? ",\"%s\"" : "\"%s\"", name);  // nomes validados em building_load
+          }
+          // Alertas ativos: [regra, andar, tipo, limite]
+          page_append(buf, size, &len, "],\"alerts\":[");
+          bool first = true;
+          for (int i = 0; i < alerts.num_rules; i++) {
+               const alert_rule_t *r = &alerts.rules[i];
+               if (r->state != ALERT_ACTIVE) continue;
+               page_append(buf, size, &len, "%s[%d,%u,\"%s\",%u]", first ? "" : ",", i, r->floor,
+                           alert_kind_names[r->kind], r->limit);
+               first = false;
+          }
+     }
+     page_append(buf, size, &len, "]");
+     *pos = len;
+ }
+ 
+ static size_t format_state_json(char *buf, size_t size, bool full) {
+     size_t len = 0;
+     page_append(buf, size, &len, "{");
+     append_state_fields(buf, size, &len, full);
+     page_append(buf, size, &len, "}");
+     return len;
+ }
+ 
+ // ETag do estado atual: muda sempre que state_version muda
+ static int format_state_etag(char *buf, size_t size) {
+     return snprintf(buf, size, "\"%08lx-%lu\"", (unsigned long)boot_id, (unsigned long)state_version);
+ }
+ 
+ // GET /api/floors: ocupação em JSON compacto, com ETag e resposta 304 quando o
+ // cliente já possui a versão atual (If-None-Match)
+ static err_t http_send_floors_json(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     char etag[HTTP_ETAG_MAX];
+     format_state_etag(etag, sizeof(etag));
+     const char *connection = keep_alive ? "keep-alive" : "close";
+     char head[160];
+     int head_len;
+     size_t body_len = 0;
+     if (http_etag_match(conn->parser.if_none_match, etag)) {
+          head_len = snprintf(head, sizeof(head),
+                              "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nConnection: %s\r\n\r\n",
+                              etag, connection);
+     } else {
+          body_len = format_state_json(state_json, sizeof(state_json), true);
+          head_len = snprintf(head, sizeof(head),
+                              "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                              "Cache-Control: no-cache\r\nETag: %s\r\nConnection: %s\r\n\r\n",
+                              (unsigned)body_len, etag, connection);
+     }
+     if (head_len < 0 || (size_t)head_len >= sizeof(head)) return ERR_BUF;
+     const http_fragment_t response[] = {
+          { head,       (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { state_json, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ // Envia a página em pedaços enquanto houver espaço no buffer TCP. Retoma de
+ // onde parou a cada ACK (sent_callback), então a memória usada não depende do
+ // número de andares nem do tamanho da página.
+ static err_t http_stream_page(http_conn_t *conn) {
+     page_stream_t *st = &conn->page;
+     struct altcp_pcb *tpcb = conn->pcb;
+     while (st->active) {
+          if (altcp_sndbuf(tpcb) < PAGE_CHUNK_MIN || altcp_sndqueuelen(tpcb) + 3 > TCP_SND_QUEUELEN) {
+               return ERR_OK;  // continua quando o cliente confirmar dados
+          }
+          size_t room = altcp_sndbuf(tpcb) - PAGE_CHUNK_OVERHEAD;
+          if (room > sizeof(page_chunk)) room = sizeof(page_chunk);
+          
+          if (st->section == PAGE_END) {
+               // Fim do corpo: chunk de tamanho zero (sem chunked, o fechamento da conexão)
+               st->section = PAGE_DONE;
+               st->active = false;
+               if (!st->chunked) break;
+               conn->unacked += 5;
+               return altcp_write(tpcb, "0\r\n\r\n", 5, 0);
+          }
+          
+          const char *data;
+          size_t len, total;
+          u8_t flags = 0;
+          if ((data = page_section_text(st->section, &total)) != NULL) {
+               // Fragmento constante: enviado da flash, sem cópia
+               data += st->offset;
+               len = total - st->offset;
+               if (len > room) len = room;
+               st->offset += (u16_t)len;
+               if (st->offset == total) {
+                    st->section++;
+                    st->offset = 0;
+               }
+          } else {
+               // Itens do cache (ou de page_chunk): copiados, pois mudam antes do ACK
+               data = page_fill_items(st, room, &len);
+               flags = TCP_WRITE_FLAG_COPY;
+          }
+          if (len == 0) continue;  // nenhum andar nesta seção
+          
+          char size_line[8];
+          int size_len = st->chunked ? snprintf(size_line, sizeof(size_line), "%x\r\n", (unsigned)len) : 0;
+          const http_fragment_t chunk[] = {
+               { size_line, (size_t)size_len,    TCP_WRITE_FLAG_COPY },
+               { data,      len,                 flags },
+               { "\r\n",    st->chunked ? 2 : 0, 0 },
+          };
+          conn->unacked += (u32_t)size_len + len + chunk[2].len;
+          err_t err = http_write_fragments(tpcb, chunk, 3);
+          if (err != ERR_OK) return err;
+     }
+     return ERR_OK;
+ }
+ 
+ // GET /: aplica a ação da query string (se houver) e começa a enviar a página.
+ // Em HTTP/1.1 o corpo vai com Transfer-Encoding: chunked; clientes HTTP/1.0
+ // recebem o corpo até o fechamento da conexão.
+ static err_t http_send_page(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     http_parser_t *req = &conn->parser;
+     if ((args->present & ARG_FLOOR) && args->action != ACTION_CLEAR_ALL && args->action != ACTION_CHECKOUT &&
+         args->floor != selected_floor) {
+          select_floor(args->floor);
+     }
+     if (args->present & ARG_ACTION) {
+          bool badge = (args->action == ACTION_CHECKIN || args->action == ACTION_CHECKOUT);
+          int value = (args->action == ACTION_SET) ? args->value : badge ? args->badge : 1;
+          if (!badge || (args->present & ARG_BADGE)) {
+               update_occupancy(args->floor, args->zone, args->action, value, EVENT_SOURCE_HTTP);
+          }
+     }
      
-     // Formulário para modificar a ocupação
-     strcat(body, "<form action=\"/\" method=\"GET\">");
-     strcat(body, "<label for=\"floor\">Selecione o Andar:</label>");
-     strcat(body, "<select name=\"floor\" id=\"floor\">");
-     for (int i = 0; i < NUM_FLOORS; i++) {
-          char option[64];
-          if(i == 0)
-               snprintf(option, sizeof(option), "<option value=\"%d\" %s>Terreo</option>", i, (i==selected_floor) ? "selected" : "");
-          else
-               snprintf(option, sizeof(option), "<option value=\"%d\" %s>Andar %d</option>", i, (i==selected_floor) ? "selected" : "", i);
-          strcat(body, option);
-     }
-     strcat(body, "</select><br/><br/>");
-     strcat(body, "<input type=\"submit\" name=\"action\" value=\"add\"> ");
-     strcat(body, "<input type=\"submit\" name=\"action\" value=\"remove\"> ");
-     strcat(body, "<input type=\"submit\" name=\"action\" value=\"clear\"> ");
-     strcat(body, "<input type=\"submit\" name=\"action\" value=\"clear_all\"> <br/><br/>");
-     strcat(body, "Ou defina a ocupacao: <input type=\"text\" name=\"value\" placeholder=\"Numero\"> ");
-     strcat(body, "<input type=\"submit\" name=\"action\" value=\"set\">");
-     strcat(body, "</form>");
+     bool chunked = req->http_minor >= 1;
+     if (!chunked) {
+          keep_alive = false;
+          conn->close_after_send = true;
+     }
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\n"
+                             "%sConnection: %s\r\n\r\n",
+                             chunked ? "Transfer-Encoding: chunked\r\n" : "",
+                             keep_alive ? "keep-alive" : "close");
+     conn->unacked += (u32_t)head_len;
+     err_t err = altcp_write(conn->pcb, head, (u16_t)head_len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+     if (err != ERR_OK) return err;
+     memset(&conn->page, 0, sizeof(conn->page));
+     conn->page.active = true;
+     conn->page.chunked = chunked;
+     return http_stream_page(conn);
+ }
+ 
+ // Página que carrega o app. Só referencia o pacote versionado (estilo e
+ // marcação ficam no próprio pacote), então muda junto com ele e usa o mesmo ETag.
+ static const char APP_SHELL[] =
+     "<!DOCTYPE html><html lang=\"pt-BR\"><head><meta charset=\"UTF-8\">"
+     "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">"
+     "<title>Monitor de Ocupacao</title></head>"
+     "<body><script src=\"" ROUTE_PATH_APP_JS "\"></script></body></html>";
+ 
+ // GET /app: página do app, revalidada pelo ETag (304 enquanto o pacote não
+ // mudar). O pacote só existe comprimido, então clientes sem gzip recebem a
+ // página gerada no servidor.
+ static err_t http_send_app(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     const http_parser_t *req = &conn->parser;
+     if (!req->accept_gzip) return http_send_page(conn, keep_alive, args);
+     const char *connection = keep_alive ? "keep-alive" : "close";
+     char head[192];
+     int head_len;
+     size_t body_len = 0;
+     if (http_etag_match(req->if_none_match, WEB_APP_ETAG)) {
+          head_len = snprintf(head, sizeof(head),
+                              "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nVary: Accept-Encoding\r\n"
+                              "Connection: %s\r\n\r\n", WEB_APP_ETAG, connection);
+     } else {
+          body_len = sizeof(APP_SHELL) - 1;
+          head_len = snprintf(head, sizeof(head),
+                              "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\n"
+                              "Content-Length: %u\r\nCache-Control: no-cache\r\nETag: %s\r\n"
+                              "Vary: Accept-Encoding\r\nConnection: %s\r\n\r\n",
+                              (unsigned)body_len, WEB_APP_ETAG, connection);
+     }
+     if (head_len < 0 || (size_t)head_len >= sizeof(head)) return ERR_BUF;
+     const http_fragment_t response[] = {
+          { head,      (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { APP_SHELL, body_len,         0 },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ // GET /app/<versão>.js: pacote do app, comprimido com gzip no build e enviado
+ // direto da flash. Como o nome muda a cada versão, o conteúdo de uma URL nunca
+ // muda e o navegador pode guardá-lo sem revalidar (immutable).
+ static err_t http_send_app_bundle(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     char head[256];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 200 OK\r\nContent-Type: application/javascript\r\n"
+                             "Content-Encoding: gzip\r\nContent-Length: %u\r\n"
+                             "Cache-Control: public, max-age=31536000, immutable\r\n"
+                             "Connection: %s\r\n\r\n",
+                             (unsigned)WEB_APP_GZ_LEN, keep_alive ? "keep-alive" : "close");
+     if (head_len < 0 || (size_t)head_len >= sizeof(head)) return ERR_BUF;
+     const http_fragment_t response[] = {
+          { head,                     (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { (const char *)web_app_gz, WEB_APP_GZ_LEN,   0 },
+     };
+     conn->unacked += (u32_t)head_len + WEB_APP_GZ_LEN;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ // GET /: página gerada no servidor ou, com WEB_UI_SPA, o app. Links antigos com
+ // ações na query string continuam sendo atendidos pela página.
+ static err_t http_send_root(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+ #if WEB_UI_SPA
+     if (args->present == 0) return http_send_app(conn, keep_alive, args);
+ #endif
+     return http_send_page(conn, keep_alive, args);
+ }
+ 
+ /* ─── EVENTOS: SERVER-SENT EVENTS E WEBSOCKET ────────────────────────── */
+ static int count_connections(conn_mode_t mode) {
+     int n = 0;
+     for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+          if (http_conns[i].pcb != NULL && http_conns[i].mode == mode) n++;
+     }
+     return n;
+ }
+ 
+ // Enfileira uma mensagem para um assinante. Assinantes que não dão conta de
+ // acompanhar (buffer de envio cheio) são desconectados; o EventSource ou o
+ // tablet reconecta e recebe um snapshot completo. O resultado do fechamento
+ // fica também em conn->close_err: num broadcast disparado pela própria
+ // conexão (comando WebSocket), a callback dela precisa devolver ERR_ABRT.
+ static err_t subscriber_send(http_conn_t *conn, const http_fragment_t *frags, size_t count) {
+     size_t total = 0;
+     for (size_t i = 0; i < count; i++) total += frags[i].len;
+     if (altcp_sndbuf(conn->pcb) < total || altcp_sndqueuelen(conn->pcb) + count > TCP_SND_QUEUELEN ||
+         http_write_fragments(conn->pcb, frags, count) != ERR_OK) {
+          printf("Assinante de eventos lento, desconectando.\n");
+          conn->close_err = http_conn_close(conn);
+          return conn->close_err;
+     }
+     conn->unacked += total;
+     altcp_output(conn->pcb);
+     return ERR_OK;
+ }
+ 
+ // Envia um payload JSON como frame de texto WebSocket
+ static err_t ws_send_text(http_conn_t *conn, const char *json, size_t len) {
+     uint8_t hdr[4];
+     size_t hdr_len = ws_frame_header(hdr, WS_OP_TEXT, len);
+     const http_fragment_t frame[] = {
+          { (const char *)hdr, hdr_len, TCP_WRITE_FLAG_COPY },
+          { json,              len,     TCP_WRITE_FLAG_COPY },
+     };
+     return subscriber_send(conn, frame, 2);
+ }
+ 
+ // Único ponto de fan-out: entrega a nova ocupação de um andar a todos os
+ // assinantes, como evento SSE ou frame de texto WebSocket
+ static void publish_floor(int floor) {
+     char json[64];
+     int len = snprintf(json, sizeof(json), "{\"floor\":%d,\"count\":%lu,\"v\":%lu}",
+                        floor, (unsigned long)building.floors[floor].count, (unsigned long)state_version);
+     if (len <= 0 || (size_t)len >= sizeof(json)) return;
+     const http_fragment_t sse_event[] = {
+          { SSE_FLOOR_PREFIX, sizeof(SSE_FLOOR_PREFIX) - 1, 0 },
+          { json,             (size_t)len,                  TCP_WRITE_FLAG_COPY },
+          { SSE_EVENT_END,    sizeof(SSE_EVENT_END) - 1,    0 },
+     };
+     for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+          http_conn_t *conn = &http_conns[i];
+          if (conn->pcb == NULL) continue;
+          if (conn->mode == CONN_SSE) subscriber_send(conn, sse_event, 3);
+          else if (conn->mode == CONN_WS) ws_send_text(conn, json, (size_t)len);
+     }
+ }
+ 
+ // Entrega aos assinantes os alertas que dispararam ou voltaram ao normal desde
+ // a última chamada, um evento "alert" por regra
+ static void publish_alerts(void) {
+     bool active;
+     int i;
+     while ((i = alerts_next_change(&alerts, &active)) >= 0) {
+          const alert_rule_t *r = &alerts.rules[i];
+          char json[128];
+          int len = snprintf(json, sizeof(json),
+                             "{\"alert\":%d,\"floor\":%u,\"rule\":\"%s\",\"limit\":%u,\"active\":%s,"
+                             "\"count\":%lu,\"since\":%lu}",
+                             i, r->floor, alert_kind_names[r->kind], r->limit, active ? "true" : "false",
+                             (unsigned long)building.floors[r->floor].count, (unsigned long)r->since_s);
+          if (len <= 0 || (size_t)len >= sizeof(json)) continue;
+          printf("Alerta %d (andar %u, %s %u): %s\n", i, r->floor, alert_kind_names[r->kind], r->limit,
+                 active ? "ativo" : "normal");
+          const http_fragment_t sse_event[] = {
+               { SSE_ALERT_PREFIX, sizeof(SSE_ALERT_PREFIX) - 1, 0 },
+               { json,             (size_t)len,                  TCP_WRITE_FLAG_COPY },
+               { SSE_EVENT_END,    sizeof(SSE_EVENT_END) - 1,    0 },
+          };
+          for (int c = 0; c < HTTP_MAX_CONNECTIONS; c++) {
+               http_conn_t *conn = &http_conns[c];
+               if (conn->pcb == NULL) continue;
+               if (conn->mode == CONN_SSE) subscriber_send(conn, sse_event, 3);
+               else if (conn->mode == CONN_WS) ws_send_text(conn, json, (size_t)len);
+          }
+     }
+ }
+
+ // Heartbeat periódico (comentário SSE / ping WebSocket) que mantém as
+ // conexões de eventos vivas; chamado pelo loop principal
+ static void events_heartbeat(void) {
+     const http_fragment_t sse_ping[] = { { SSE_HEARTBEAT, sizeof(SSE_HEARTBEAT) - 1, 0 } };
+     const http_fragment_t ws_ping[] = { { WS_PING_FRAME, sizeof(WS_PING_FRAME), 0 } };
+     for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+          http_conn_t *conn = &http_conns[i];
+          if (conn->pcb == NULL) continue;
+          if (conn->mode == CONN_SSE) subscriber_send(conn, sse_ping, 1);
+          else if (conn->mode == CONN_WS) subscriber_send(conn, ws_ping, 1);
+     }
+ }
+ 
+ // GET /events: transforma a conexão em assinante e envia o estado atual
+ static err_t http_start_sse(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     if (count_connections(CONN_SSE) >= SSE_MAX_SUBSCRIBERS) {
+          conn->close_after_send = true;
+          conn->unacked += sizeof(HTTP_503_RESPONSE) - 1;
+          return altcp_write(conn->pcb, HTTP_503_RESPONSE, sizeof(HTTP_503_RESPONSE) - 1, 0);
+     }
+     
+     // Estado completo, enviado ao assinante logo após conectar
+     size_t len = format_state_json(state_json, sizeof(state_json), true);
+     
+     conn->mode = CONN_SSE;
+     const http_fragment_t response[] = {
+          { SSE_HEAD,                sizeof(SSE_HEAD) - 1,                0 },
+          { "event: snapshot\ndata: ", sizeof("event: snapshot\ndata: ") - 1, 0 },
+          { state_json,              len,                                 TCP_WRITE_FLAG_COPY },
+          { SSE_EVENT_END,           sizeof(SSE_EVENT_END) - 1,           0 },
+     };
+     conn->unacked += (sizeof(SSE_HEAD) - 1) + (sizeof("event: snapshot\ndata: ") - 1) + len + 2;
+     return http_write_fragments(conn->pcb, response, sizeof(response) / sizeof(response[0]));
+ }
+ 
+ // GET /ws: handshake WebSocket (RFC 6455) e envio do estado atual
+ static err_t http_start_websocket(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     http_parser_t *req = &conn->parser;
+     if (!req->upgrade_websocket || !req->connection_upgrade || req->websocket_key[0] == '\0') {
+          conn->close_after_send = true;
+          conn->unacked += sizeof(HTTP_426_RESPONSE) - 1;
+          return altcp_write(conn->pcb, HTTP_426_RESPONSE, sizeof(HTTP_426_RESPONSE) - 1, 0);
+     }
+     if (count_connections(CONN_WS) >= WS_MAX_CLIENTS) {
+          conn->close_after_send = true;
+          conn->unacked += sizeof(HTTP_503_RESPONSE) - 1;
+          return altcp_write(conn->pcb, HTTP_503_RESPONSE, sizeof(HTTP_503_RESPONSE) - 1, 0);
+     }
      
-     // Tabela com o status de todos os andares
-     strcat(body, "<h2>Status dos Andares</h2>");
-     strcat(body, "<table>");
-     strcat(body, "<tr><th>Andar</th><th>Ocupacao</th></tr>");
-     for (int i = 0; i < NUM_FLOORS; i++) {
-          char row[128];
-          if (i == 0)
-               snprintf(row, sizeof(row), "<tr><td>Terreo</td><td>%d pessoas</td></tr>", occupancy[i]);
-          else
-               snprintf(row, sizeof(row), "<tr><td>Andar %d</td><td>%d pessoas</td></tr>", i, occupancy[i]);
-          strcat(body, row);
-     }
-     strcat(body, "</table>");
+     char accept[WS_ACCEPT_KEY_SIZE];
+     ws_accept_key(req->websocket_key, accept);
+     char head[160];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                             "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n", accept);
+     if (head_len <= 0 || (size_t)head_len >= sizeof(head)) return ERR_BUF;
      
-     strcat(body, "</body></html>");
+     // A partir daqui a conexão fala WebSocket: o estado HTTP dá lugar ao leitor de frames
+     conn->mode = CONN_WS;
+     ws_parser_reset(&conn->ws);
+     conn->unacked += (u32_t)head_len;
+     err_t err = altcp_write(conn->pcb, head, (u16_t)head_len, TCP_WRITE_FLAG_COPY);
+     if (err != ERR_OK) return err;
      
-     snprintf(buffer, buffer_size,
-              "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\nConnection: close\r\n\r\n%s",
-              body);
+     size_t len = format_state_json(state_json, sizeof(state_json), true);
+     uint8_t hdr[4];
+     size_t hdr_len = ws_frame_header(hdr, WS_OP_TEXT, len);
+     const http_fragment_t frame[] = {
+          { (const char *)hdr, hdr_len, TCP_WRITE_FLAG_COPY },
+          { state_json,        len,     TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += hdr_len + len;
+     return http_write_fragments(conn->pcb, frame, 2);
  }
  
- /* ─── FUNÇÕES DO SERVIDOR HTTP ───────────────────────────────────────── */
- // Callback chamada após envio completo da resposta HTTP (fecha a conexão)
- static err_t sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-     printf("Resposta enviada, fechando conexao.\n");
-     tcp_arg(tpcb, NULL);
-     tcp_recv(tpcb, NULL);
-     tcp_sent(tpcb, NULL);
-     err_t err = tcp_close(tpcb);
+ // Executa um comando de texto recebido por WebSocket:
+ //   "add N", "remove N", "clear N", "set N V", "clear_all", "select N",
+ //   "checkin ID N" ou "checkout ID"
+ // N é o andar ou "andar.zona" (ver parse_target). O resultado volta a todos
+ // os clientes (inclusive o remetente) via publish_floor.
+ static void ws_handle_command(http_conn_t *conn, const uint8_t *msg, size_t len) {
+     char text[WS_MAX_MESSAGE + 1];
+     memcpy(text, msg, len);
+     text[len] = '\0';
+     
+     char action[16] = "", floor_str[12] = "", value_str[8] = "";
+     int fields = sscanf(text, "%15s %11s %7s", action, floor_str, value_str);
+     int floor = 0, zone = -1, value = 0;
+     bool has_floor = fields >= 2 && parse_target(floor_str, &floor, &zone);
+     occupancy_action_t act = (fields >= 1) ? parse_action(action) : ACTION_NONE;
+     switch (act) {
+     case ACTION_NONE:
+          if (fields >= 1 && strcmp(action, "select") == 0 && has_floor && zone < 0) {
+               select_floor(floor);
+               update_led_status();
+               request_render(RENDER_OLED | RENDER_MATRIX);
+               return;
+          }
+          break;
+     case ACTION_CLEAR_ALL:
+          update_occupancy(0, -1, act, 0, EVENT_SOURCE_WS);
+          return;
+     case ACTION_CHECKIN:
+     case ACTION_CHECKOUT: {
+          // O segundo campo é o crachá; o alvo do check-in vem no terceiro
+          int badge;
+          if (fields < 2 || !parse_uint(floor_str, INT32_MAX, &badge) || badge == 0) break;
+          if (act == ACTION_CHECKIN && !(fields == 3 && parse_target(value_str, &floor, &zone))) break;
+          if (!update_occupancy(floor, zone, act, badge, EVENT_SOURCE_WS)) {
+               static const char refused[] = "{\"error\":\"cracha recusado\"}";
+               ws_send_text(conn, refused, sizeof(refused) - 1);
+          }
+          return;
+     }
+     case ACTION_SET:
+          if (has_floor && fields == 3 && parse_uint(value_str, INT16_MAX, &value)) {
+               update_occupancy(floor, zone, act, value, EVENT_SOURCE_WS);
+               return;
+          }
+          break;
+     default:
+          if (has_floor) {
+               update_occupancy(floor, zone, act, 1, EVENT_SOURCE_WS);
+               return;
+          }
+          break;
+     }
+     static const char error[] = "{\"error\":\"comando invalido\"}";
+     ws_send_text(conn, error, sizeof(error) - 1);
+ }
+ 
+ // Responde a um frame de controle ou encerra a conexão WebSocket.
+ // Retorna false se a conexão deve ser fechada após o envio.
+ static bool ws_handle_control(http_conn_t *conn) {
+     ws_parser_t *ws = &conn->ws;
+     uint8_t hdr[4];
+     if (ws->opcode == WS_OP_PING) {
+          size_t hdr_len = ws_frame_header(hdr, WS_OP_PONG, ws->ctl_len);
+          const http_fragment_t pong[] = {
+               { (const char *)hdr,     hdr_len,     TCP_WRITE_FLAG_COPY },
+               { (const char *)ws->ctl, ws->ctl_len, TCP_WRITE_FLAG_COPY },
+          };
+          subscriber_send(conn, pong, 2);
+          return conn->pcb != NULL;
+     }
+     if (ws->opcode == WS_OP_CLOSE) {
+          // Ecoa o código de status recebido (se houver) e fecha
+          size_t code_len = ws->ctl_len >= 2 ? 2 : 0;
+          size_t hdr_len = ws_frame_header(hdr, WS_OP_CLOSE, code_len);
+          const http_fragment_t close_frame[] = {
+               { (const char *)hdr,     hdr_len,  TCP_WRITE_FLAG_COPY },
+               { (const char *)ws->ctl, code_len, TCP_WRITE_FLAG_COPY },
+          };
+          subscriber_send(conn, close_frame, 2);
+          return false;
+     }
+     return true;  // PONG: nada a fazer
+ }
+ 
+ // Consome os frames recebidos numa conexão WebSocket, direto dos pbufs
+ static err_t ws_process_frames(http_conn_t *conn) {
+     while (conn->pcb != NULL && conn->pending != NULL && !conn->close_after_send) {
+          ws_parse_result_t result = WS_PARSE_INCOMPLETE;
+          size_t total = 0;
+          for (struct pbuf *q = conn->pending; q != NULL; q = q->next) {
+               size_t used;
+               result = ws_parser_feed(&conn->ws, (const uint8_t *)q->payload, q->len, &used);
+               total += used;
+               if (result != WS_PARSE_INCOMPLETE) break;
+          }
+          conn->pending = pbuf_free_header(conn->pending, (u16_t)total);
+          altcp_recved(conn->pcb, (u16_t)total);
+          
+          if (result == WS_PARSE_INCOMPLETE) break;
+          if (result == WS_PARSE_ERROR) {
+               uint8_t frame[4];
+               ws_frame_header(frame, WS_OP_CLOSE, 2);
+               frame[2] = (uint8_t)(conn->ws.close_code >> 8);
+               frame[3] = (uint8_t)conn->ws.close_code;
+               const http_fragment_t close_frame[] = { { (const char *)frame, 4, TCP_WRITE_FLAG_COPY } };
+               subscriber_send(conn, close_frame, 1);
+               conn->close_after_send = true;
+          } else if (conn->ws.opcode == WS_OP_TEXT) {
+               ws_handle_command(conn, conn->ws.msg, conn->ws.msg_len);
+          } else if (conn->ws.opcode != WS_OP_BINARY && !ws_handle_control(conn)) {
+               conn->close_after_send = true;
+          }
+     }
+     // Fechada por subscriber_send, ao responder ou num broadcast causado pelo
+     // próprio comando: ERR_ABRT tem de chegar ao lwIP
+     if (conn->pcb == NULL) return conn->close_err;
+     if (conn->close_after_send && conn->pending) {
+          altcp_recved(conn->pcb, conn->pending->tot_len);
+          pbuf_free(conn->pending);
+          conn->pending = NULL;
+     }
+     return ERR_OK;
+ }
+ 
+ /* ─── CONFIGURAÇÃO DO PRÉDIO ─────────────────────────────────────────── */
+ // Configuração recebida por POST /api/config. Um envio por vez: o texto vai
+ // direto dos pbufs para cá e, depois de validado, o loop principal o grava na
+ // flash (o XIP para durante a gravação) e reinicia a placa.
+ static struct {
+     const http_conn_t *conn;         // conexão que está enviando o corpo
+     size_t len;
+     bool ready;                      // validada, aguardando a gravação
+     absolute_time_t deadline;        // quando gravar e reiniciar
+     char text[CONFIG_STORE_MAX + 1];
+ } config_upload;
+ 
+ // Outra conexão ainda está enviando uma configuração, ou há uma aguardando a
+ // gravação. Uma conexão encerrada no meio do corpo não prende o envio.
+ static bool config_upload_busy(void) {
+     const http_conn_t *c = config_upload.conn;
+     return config_upload.ready ||
+            (c && c->pcb && c->mode == CONN_HTTP && c->batch.active && c->parser.route == ROUTE_CONFIG);
+ }
+ 
+ /* ─── ATUALIZAÇÃO EM LOTE ─────────────────────────────────────────────── */
+ // Interpreta uma linha "andar[.zona],acao[,valor]" do corpo. Para "clear_all"
+ // e "checkout" o andar pode ser "*" ou vazio; para "add"/"remove" o valor
+ // padrão é 1; "checkin"/"checkout" exigem o crachá como valor.
+ static void batch_parse_line(batch_state_t *b) {
+     b->line[b->line_len] = '\0';
+     b->line_len = 0;
+     if (b->line[0] == '\0' || b->error_line) return;  // linha vazia ou lote já inválido
+     b->lines++;
+     
+     char *floor_str = b->line;
+     char *action = strchr(floor_str, ',');
+     if (!action) {
+          b->error_line = b->lines;
+          return;
+     }
+     *action++ = '\0';
+     char *value_str = strchr(action, ',');
+     if (value_str) *value_str++ = '\0';
+     
+     occupancy_action_t act = parse_action(action);
+     bool badge = (act == ACTION_CHECKIN || act == ACTION_CHECKOUT);
+     int floor = 0, zone = -1, value = 0;
+     if (act == ACTION_NONE ||
+         (value_str && !parse_uint(value_str, badge ? INT32_MAX : INT16_MAX, &value)) ||
+         ((act == ACTION_SET || badge) && !value_str) || (badge && value == 0) ||
+         (act != ACTION_CLEAR_ALL && act != ACTION_CHECKOUT && !parse_target(floor_str, &floor, &zone))) {
+          b->error_line = b->lines;
+          return;
+     }
+     if ((act == ACTION_ADD || act == ACTION_REMOVE) && value == 0) value = 1;
+     if (b->num_ops >= BATCH_MAX_OPS) {
+          b->too_many = true;
+          b->error_line = b->lines;
+          return;
+     }
+     b->ops[b->num_ops++] = (batch_op_t){ (u8_t)floor, (u8_t)act, (int16_t)zone, value, b->lines };
+ }
+ 
+ // Consome o corpo do lote direto dos pbufs pendentes (o de uma configuração é
+ // copiado como veio). Retorna true quando o corpo inteiro foi lido.
+ static bool batch_feed_pending(http_conn_t *conn) {
+     batch_state_t *b = &conn->batch;
+     bool config = (conn->parser.route == ROUTE_CONFIG);
+     size_t total = 0;
+     for (struct pbuf *q = conn->pending; q != NULL && b->remaining > 0; q = q->next) {
+          const char *data = (const char *)q->payload;
+          size_t n = q->len;
+          if (n > b->remaining) n = b->remaining;
+          if (config) {
+               memcpy(config_upload.text + config_upload.len, data, n);  // limitado em batch_begin
+               config_upload.len += n;
+          }
+          for (size_t i = 0; i < n && !config; i++) {
+               char c = data[i];
+               if (c == '\n' || c == ';') {
+                    batch_parse_line(b);
+               } else if (c != '\r') {
+                    if (b->line_len < BATCH_LINE_MAX - 1) b->line[b->line_len++] = c;
+                    else if (!b->error_line) b->error_line = b->lines + 1;  // linha longa demais
+               }
+          }
+          b->remaining -= n;
+          total += n;
+     }
+     if (total > 0) {
+          conn->pending = pbuf_free_header(conn->pending, (u16_t)total);
+          altcp_recved(conn->pcb, (u16_t)total);
+     }
+     if (b->remaining > 0) return false;
+     if (!config) batch_parse_line(b);  // última linha sem terminador
+     return true;
+ }
+ 
+ // Inicia a leitura do corpo de um POST. Retorna false (com parser.status
+ // preenchido) se a requisição deve ser recusada antes de ler o corpo.
+ static bool batch_begin(http_conn_t *conn) {
+     http_parser_t *req = &conn->parser;
+     bool config = (req->route == ROUTE_CONFIG);
+     memset(&conn->batch, 0, sizeof(conn->batch));
+     if (req->route != ROUTE_BATCH && !config) {
+          req->status = (req->route == ROUTE_NOT_FOUND) ? 404 : 405;
+     } else if (!req->has_content_length) {
+          req->status = 411;
+     } else if (req->content_length > (config ? CONFIG_STORE_MAX : BATCH_MAX_BODY)) {
+          req->status = 413;
+     } else if (config && config_upload_busy()) {
+          req->status = 503;
+     } else {
+          if (config) {
+               config_upload.conn = conn;
+               config_upload.len = 0;
+          }
+          conn->batch.active = true;
+          conn->batch.remaining = req->content_length;
+          return true;
+     }
+     return false;
+ }
+ 
+ // Simulação de um lote sobre o estado atual, sem efeitos colaterais. Só as
+ // zonas e os crachás tocados pelo lote ficam na sobreposição; zerar um andar
+ // só marca o andar (as zonas dele ainda não tocadas passam a valer zero).
+ typedef struct {
+     u16_t zone;
+     u16_t count;
+     u16_t badges;
+     bool cleared;                    // os crachás de antes do lote foram retirados
+ } batch_sim_zone_t;
+ 
+ typedef struct {
+     u32_t id;
+     int16_t zone;                    // -1 = fora do prédio
+ } batch_sim_badge_t;
+ 
+ typedef struct {
+     batch_sim_zone_t zones[2 * BATCH_MAX_OPS];   // check-in com troca toca duas zonas
+     u16_t num_zones;
+     batch_sim_badge_t badges[BATCH_MAX_OPS];
+     u16_t num_badges;
+     u32_t floor_cleared[(BUILDING_MAX_FLOORS + 31) / 32];
+     u32_t table_count;               // crachás na tabela
+ } batch_sim_t;
+ 
+ static bool sim_floor_cleared(const batch_sim_t *s, u8_t floor) {
+     return (s->floor_cleared[floor / 32] >> (floor % 32)) & 1u;
+ }
+ 
+ static batch_sim_zone_t *sim_find_zone(batch_sim_t *s, u16_t z) {
+     for (u16_t i = 0; i < s->num_zones; i++) {
+          if (s->zones[i].zone == z) return &s->zones[i];
+     }
+     return NULL;
+ }
+ 
+ // Zona na sobreposição, copiada do modelo no primeiro uso
+ static batch_sim_zone_t *sim_zone(batch_sim_t *s, u16_t z) {
+     batch_sim_zone_t *e = sim_find_zone(s, z);
+     if (e) return e;
+     e = &s->zones[s->num_zones++];
+     e->zone = z;
+     e->cleared = sim_floor_cleared(s, building.zone_floor[z]);
+     e->count = e->cleared ? 0 : building.zone_count[z];
+     e->badges = e->cleared ? 0 : zone_badges[z];
+     return e;
+ }
+ 
+ // Zona atual de um crachá no lote (-1 se fora)
+ static int sim_badge_zone(batch_sim_t *s, u32_t id) {
+     for (u16_t i = 0; i < s->num_badges; i++) {
+          if (s->badges[i].id == id) return s->badges[i].zone;
+     }
+     u16_t z;
+     if (!presence_lookup(&presence, id, &z)) return -1;
+     const batch_sim_zone_t *e = sim_find_zone(s, z);
+     if (sim_floor_cleared(s, building.zone_floor[z]) || (e && e->cleared)) return -1;
+     return z;
+ }
+ 
+ static void sim_set_badge(batch_sim_t *s, u32_t id, int zone) {
+     for (u16_t i = 0; i < s->num_badges; i++) {
+          if (s->badges[i].id == id) {
+               s->badges[i].zone = (int16_t)zone;
+               return;
+          }
+     }
+     s->badges[s->num_badges++] = (batch_sim_badge_t){ id, (int16_t)zone };
+ }
+ 
+ // Zera as zonas [first, first + count); um andar inteiro (floor >= 0) só é marcado
+ static void sim_clear(batch_sim_t *s, u16_t first, u16_t count, int floor) {
+     for (u16_t z = first; z < first + count; z++) {
+          const batch_sim_zone_t *e = sim_find_zone(s, z);
+          s->table_count -= e ? e->badges : sim_floor_cleared(s, building.zone_floor[z]) ? 0 : zone_badges[z];
+     }
+     if (floor >= 0) s->floor_cleared[floor / 32] |= 1u << (floor % 32);
+     else sim_zone(s, first);
+     for (u16_t i = 0; i < s->num_zones; i++) {
+          batch_sim_zone_t *e = &s->zones[i];
+          if (e->zone >= first && e->zone - first < count) *e = (batch_sim_zone_t){ e->zone, 0, 0, true };
+     }
+     for (u16_t i = 0; i < s->num_badges; i++) {
+          int z = s->badges[i].zone;
+          if (z >= first && z - first < count) s->badges[i].zone = -1;
+     }
+ }
+ 
+ // Aplica uma operação na simulação, com as mesmas regras de apply_action
+ static bool sim_op(batch_sim_t *s, const batch_op_t *op) {
+     if (op->action == ACTION_CLEAR_ALL) {
+          sim_clear(s, 0, building.num_zones, -1);
+          memset(s->floor_cleared, 0xFF, sizeof(s->floor_cleared));
+          return true;
+     }
+     if (op->action == ACTION_CHECKOUT) {
+          int z = sim_badge_zone(s, (u32_t)op->value);
+          if (z < 0) return false;
+          batch_sim_zone_t *e = sim_zone(s, (u16_t)z);
+          e->badges--;
+          if (e->count > 0) e->count--;
+          sim_set_badge(s, (u32_t)op->value, -1);
+          s->table_count--;
+          return true;
+     }
+     int z = building_zone_index(&building, op->floor, op->zone < 0 ? 0 : op->zone);
+     if (z < 0) return false;
+     if (op->action == ACTION_CLEAR) {
+          const building_floor_t *f = &building.floors[op->floor];
+          if (op->zone < 0) sim_clear(s, f->first_zone, f->num_zones, op->floor);
+          else sim_clear(s, (u16_t)z, 1, -1);
+          return true;
+     }
+     batch_sim_zone_t *e = sim_zone(s, (u16_t)z);
+     int32_t cap = building.zone_capacity[z];
+     switch (op->action) {
+     case ACTION_ADD:
+          e->count = (u16_t)((int32_t)e->count + op->value > cap ? cap : (int32_t)e->count + op->value);
+          return true;
+     case ACTION_REMOVE:
+          if ((int32_t)e->count - op->value < (int32_t)e->badges) return false;
+          e->count = (u16_t)(e->count - op->value);
+          return true;
+     case ACTION_SET:
+          if (op->value < (int32_t)e->badges) return false;
+          e->count = (u16_t)(op->value > cap ? cap : op->value);
+          return true;
+     case ACTION_CHECKIN: {
+          int cur = sim_badge_zone(s, (u32_t)op->value);
+          if (cur == z) return true;  // só renova o instante
+          if (e->count >= cap) return false;
+          if (cur < 0) {
+               if (s->table_count >= PRESENCE_MAX_ENTRIES) return false;
+               s->table_count++;
+          } else {
+               batch_sim_zone_t *old = sim_zone(s, (u16_t)cur);
+               old->badges--;
+               if (old->count > 0) old->count--;
+          }
+          e->badges++;
+          e->count++;
+          sim_set_badge(s, (u32_t)op->value, z);
+          return true;
+     }
+     default:
+          return true;
+     }
+ }
+ 
+ // Primeira operação que seria recusada, aplicando as anteriores em ordem;
+ // -1 se o lote inteiro pode ser aplicado
+ static int batch_validate(const batch_state_t *b) {
+     static batch_sim_t sim;
+     memset(&sim, 0, sizeof(sim));
+     sim.table_count = presence.count;
+     for (u8_t i = 0; i < b->num_ops; i++) {
+          if (!sim_op(&sim, &b->ops[i])) return i;
+     }
+     return -1;
+ }
+ 
+ // POST /api/batch: aplica todas as operações de uma vez (ou nenhuma, se
+ // alguma linha for inválida) e atualiza OLED e matriz uma única vez
+ static err_t http_apply_batch(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     batch_state_t *b = &conn->batch;
+     char *body = state_json;
+     size_t body_len = 0;
+     const char *status = "200 OK";
+     int rejected;
+     
+     if (b->error_line) {
+          status = b->too_many ? "413 Payload Too Large" : "400 Bad Request";
+          page_append(body, STATE_JSON_MAX, &body_len, "{\"error\":\"%s\",\"line\":%u}",
+                      b->too_many ? "operacoes demais" : "linha invalida", (unsigned)b->error_line);
+     } else if ((rejected = batch_validate(b)) >= 0) {
+          // Recusada com o estado atual (lotação, crachá ausente...): nada é aplicado
+          status = "409 Conflict";
+          page_append(body, STATE_JSON_MAX, &body_len, "{\"error\":\"operacao recusada\",\"line\":%u}",
+                      (unsigned)b->ops[rejected].line);
+     } else {
+          // Todas as operações já foram simuladas em ordem, então nenhuma é
+          // recusada aqui. O lote inteiro é uma escrita só, e o core1 nunca
+          // desenha metade dele.
+          seqlock_write_begin(&state_lock);
+          for (u8_t i = 0; i < b->num_ops; i++) {
+               apply_action(b->ops[i].floor, b->ops[i].zone, (occupancy_action_t)b->ops[i].action,
+                            b->ops[i].value, EVENT_SOURCE_BATCH);
+          }
+          seqlock_write_end(&state_lock);
+          if (b->num_ops > 0) commit_occupancy();
+          page_append(body, STATE_JSON_MAX, &body_len, "{\"applied\":%u,", (unsigned)b->num_ops);
+          append_state_fields(body, STATE_JSON_MAX, &body_len, false);
+          page_append(body, STATE_JSON_MAX, &body_len, "}");
+     }
+     b->active = false;
+     
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                             "Connection: %s\r\n\r\n",
+                             status, (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+     const http_fragment_t response[] = {
+          { head, (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { body, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ // POST /api/config: valida a configuração recebida (formato de
+ // building_config.h) e agenda a gravação; o loop principal grava e reinicia a
+ // placa para carregá-la. A ocupação salva só é restaurada se o texto for o
+ // mesmo (ver flash_store_hash no boot). Corpo vazio volta para a do build.
+ static err_t http_apply_config(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     static building_model_t check;   // só para validar (fora da pilha)
+     char body[128];
+     size_t body_len = 0;
+     const char *status = "202 Accepted";
+     unsigned line = 0;
+     conn->batch.active = false;
+     config_upload.conn = NULL;
+     config_upload.text[config_upload.len] = '\0';
+     const char *text = config_upload.len ? config_upload.text : BUILDING_CONFIG;
+     if (memchr(config_upload.text, '\0', config_upload.len) != NULL || !building_load(&check, text, &line)) {
+          status = "400 Bad Request";
+          page_append(body, sizeof(body), &body_len, "{\"error\":\"configuracao invalida\",\"line\":%u}", line);
+     } else {
+          config_upload.ready = true;
+          config_upload.deadline = make_timeout_time_ms(CONFIG_REBOOT_DELAY_MS);
+          keep_alive = false;
+          conn->close_after_send = true;
+          page_append(body, sizeof(body), &body_len, "{\"buildings\":%u,\"floors\":%u,\"zones\":%u,\"reboot\":true}",
+                      check.num_buildings, check.num_floors, check.num_zones);
+     }
+     
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                             "Connection: %s\r\n\r\n",
+                             status, (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+     const http_fragment_t response[] = {
+          { head, (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { body, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ static const char *const event_source_names[EVENT_SOURCE_COUNT] = {
+     [EVENT_SOURCE_HTTP]  = "http",
+     [EVENT_SOURCE_WS]    = "ws",
+     [EVENT_SOURCE_BATCH] = "batch",
+     [EVENT_SOURCE_EXPIRE] = "expire",
+ };
+ 
+ // Registro do histórico em JSON: [seq, t, andar, zona, delta, "origem"]
+ #define CHECKIN_JSON_MAX  sizeof("[4294967295,4294967295,255,65535,-131072,\"batch\"],")
+ _Static_assert(96 + CHECKINS_PAGE_MAX * CHECKIN_JSON_MAX <= STATE_JSON_MAX,
+                "pagina de /api/checkins nao cabe em state_json");
+ 
+ // GET /api/checkins?cursor=N&limit=M: registros do histórico a partir da
+ // sequência N. "next" é o cursor da próxima leitura; se o cursor já foi
+ // sobrescrito a leitura começa no mais antigo e "lost" diz quantos o cliente
+ // perdeu. "boot" muda a cada reinício (os cursores recomeçam do zero) e "now"
+ // é o instante atual, na mesma escala de t (segundos desde o boot).
+ static err_t http_send_checkins(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     uint32_t oldest = event_log_oldest(&checkin_log);
+     uint32_t next = checkin_log.next_seq;
+     uint32_t cursor = (args->present & ARG_CURSOR) ? (uint32_t)args->cursor : oldest;
+     uint32_t lost = 0;
+     if (cursor > next) {
+          cursor = oldest;                 // cursor de um boot anterior
+     } else if (cursor < oldest) {
+          lost = oldest - cursor;
+          cursor = oldest;
+     }
+     uint32_t limit = (args->present & ARG_LIMIT) ? (uint32_t)args->limit : CHECKINS_PAGE_MAX;
+     
+     size_t body_len = 0;
+     page_append(state_json, sizeof(state_json), &body_len,
+                 "{\"boot\":\"%08lx\",\"now\":%lu,\"lost\":%lu,"
+                 "\"fields\":[\"seq\",\"t\",\"floor\",\"zone\",\"delta\",\"src\"],\"events\":[",
+                 (unsigned long)boot_id, (unsigned long)uptime_s(),
+                 (unsigned long)lost);
+     uint32_t seq = cursor;
+     for (; seq < next && seq - cursor < limit; seq++) {
+          const event_record_t *r = event_log_get(&checkin_log, seq);
+          const building_floor_t *f = &building.floors[building.zone_floor[r->zone]];
+          page_append(state_json, sizeof(state_json), &body_len, "%s[%lu,%lu,%u,%u,%ld,\"%s\"]",
+                      (seq == cursor) ? "" : ",", (unsigned long)seq, (unsigned long)r->time_s,
+                      (unsigned)building.zone_floor[r->zone], (unsigned)(r->zone - f->first_zone),
+                      (long)r->delta, event_source_names[r->source]);
+     }
+     page_append(state_json, sizeof(state_json), &body_len, "],\"next\":%lu}", (unsigned long)seq);
+     
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                             "Cache-Control: no-store\r\nConnection: %s\r\n\r\n",
+                             (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+     const http_fragment_t response[] = {
+          { head,       (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { state_json, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ static const char *const series_level_names[TIMESERIES_LEVELS] = {
+     [TIMESERIES_MINUTE] = "minute",
+     [TIMESERIES_HOUR]   = "hour",
+     [TIMESERIES_DAY]    = "day",
+ };
+
+ // Período da série em JSON: [min, max, média, pessoas×minuto]
+ #define SERIES_POINT_JSON_MAX  sizeof("[65535,65535,65535.9,71582788],")
+ _Static_assert(160 + TIMESERIES_MAX_POINTS * SERIES_POINT_JSON_MAX <= STATE_JSON_MAX,
+                "resposta de /api/timeseries nao cabe em state_json");
+
+ // GET /api/timeseries?floor=N&res=minute|hour|day&from=S&to=S: ocupação do
+ // andar nos períodos guardados que cruzam [from, to] (segundos desde o boot,
+ // padrão: tudo). Os períodos são consecutivos: o i-ésimo começa em
+ // start + i*step. "mean" é a média ponderada pelo tempo e "pmin" a integral
+ // em pessoas×minuto; o primeiro e o último período podem estar incompletos
+ // ("first_s"/"last_s" dizem quantos segundos cobrem). floor é obrigatório.
+ static err_t http_send_series(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     uint32_t now_s = uptime_s();
+     uint32_t from = (args->present & ARG_FROM) ? (uint32_t)args->from : 0;
+     uint32_t to = (args->present & ARG_TO) ? (uint32_t)args->to : now_s;
+     size_t body_len = 0;
+     const char *status = "200 OK";
+     if (!(args->present & ARG_FLOOR)) {
+          // Ausente, não numérico ou fora do prédio: não há andar padrão
+          status = "400 Bad Request";
+          page_append(state_json, sizeof(state_json), &body_len, "{\"error\":\"andar invalido\",\"floors\":%u}",
+                      building.num_floors);
+     } else {
+          uint32_t first = 0;
+          uint32_t n = timeseries_range(&occupancy_series, (uint8_t)args->floor, args->res, from, to, now_s, &first);
+          timeseries_point_t pt = { 0 };
+          uint32_t first_s = 0;
+          page_append(state_json, sizeof(state_json), &body_len,
+                      "{\"boot\":\"%08lx\",\"now\":%lu,\"floor\":%d,\"res\":\"%s\",\"step\":%lu,\"start\":%lu,"
+                      "\"fields\":[\"min\",\"max\",\"mean\",\"pmin\"],\"points\":[",
+                      (unsigned long)boot_id, (unsigned long)now_s, args->floor, series_level_names[args->res],
+                      (unsigned long)timeseries_period_s(args->res),
+                      (unsigned long)(first * timeseries_period_s(args->res)));
+          for (uint32_t i = 0; i < n; i++) {
+               timeseries_point(&occupancy_series, (uint8_t)args->floor, args->res, first + i, &pt);
+               if (i == 0) first_s = pt.seconds;
+               // Média com uma casa decimal; período de duração zero vale a ocupação do início
+               uint32_t mean10 = pt.seconds ? (uint32_t)((uint64_t)pt.person_s * 10 / pt.seconds) : pt.min * 10u;
+               page_append(state_json, sizeof(state_json), &body_len, "%s[%u,%u,%lu.%lu,%lu]",
+                           i ? "," : "", pt.min, pt.max, (unsigned long)(mean10 / 10), (unsigned long)(mean10 % 10),
+                           (unsigned long)(pt.person_s / 60));
+          }
+          page_append(state_json, sizeof(state_json), &body_len, "],\"first_s\":%lu,\"last_s\":%lu}",
+                      (unsigned long)first_s, (unsigned long)(n ? pt.seconds : 0));
+     }
+
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                             "Cache-Control: no-store\r\nConnection: %s\r\n\r\n",
+                             status, (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+     const http_fragment_t response[] = {
+          { head,       (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { state_json, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+
+ // GET /api/occupancy?floor=N&from=S&to=S: soma e pico da ocupação do andar
+ // nos minutos guardados (o último dia, ou menos em prédios com mais de 5
+ // andares) que cruzam [from, to] (segundos desde o boot, padrão: tudo), sem
+ // percorrer os minutos (ver minute_index.c). "pmin" é a integral em
+ // pessoas×minuto, "mean" a média no tempo coberto ("seconds") e "peak" a maior
+ // ocupação; "from"/"to" voltam alinhados aos minutos usados. floor é
+ // obrigatório (400 sem ele).
+ static err_t http_send_occupancy(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     uint32_t now_s = uptime_s();
+     uint32_t from = (args->present & ARG_FROM) ? (uint32_t)args->from : 0;
+     uint32_t to = (args->present & ARG_TO) ? (uint32_t)args->to : now_s;
+     minute_index_range_t r;
+     char body[192];
+     size_t body_len = 0;
+     const char *status = "200 OK";
+     if (!(args->present & ARG_FLOOR)) {
+          // Ausente, não numérico ou fora do prédio: não há andar padrão
+          status = "400 Bad Request";
+          page_append(body, sizeof(body), &body_len, "{\"error\":\"andar invalido\",\"floors\":%u}",
+                      building.num_floors);
+     } else if (!minute_index_query(&minute_index, (uint8_t)args->floor, from, to, now_s, &r)) {
+          page_append(body, sizeof(body), &body_len,
+                      "{\"boot\":\"%08lx\",\"now\":%lu,\"floor\":%d,\"seconds\":0}",
+                      (unsigned long)boot_id, (unsigned long)now_s, args->floor);
+     } else {
+          // Média com uma casa decimal; faixa de duração zero vale o pico
+          uint32_t mean10 = r.seconds ? (uint32_t)((uint64_t)r.person_s * 10 / r.seconds) : r.peak * 10u;
+          page_append(body, sizeof(body), &body_len,
+                      "{\"boot\":\"%08lx\",\"now\":%lu,\"floor\":%d,\"from\":%lu,\"to\":%lu,\"seconds\":%lu,"
+                      "\"pmin\":%lu,\"mean\":%lu.%lu,\"peak\":%u}",
+                      (unsigned long)boot_id, (unsigned long)now_s, args->floor, (unsigned long)(r.first_min * 60),
+                      (unsigned long)(r.last_min * 60 + 59), (unsigned long)r.seconds,
+                      (unsigned long)(r.person_s / 60), (unsigned long)(mean10 / 10), (unsigned long)(mean10 % 10),
+                      r.peak);
+     }
+
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                             "Cache-Control: no-store\r\nConnection: %s\r\n\r\n",
+                             status, (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+     const http_fragment_t response[] = {
+          { head, (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { body, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+
+ // GET /api/tls: handshakes do servidor HTTPS e quantos foram retomados pelo
+ // cache de sessões/tickets (abreviados, sem a troca de chaves ECDHE)
+ static err_t http_send_tls_stats(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     char body[192];
+     size_t body_len = 0;
+ #if HTTPS_ENABLED
+     const tls_server_stats_t *st = tls_server_stats();
+     page_append(body, sizeof(body), &body_len,
+                 "{\"enabled\":true,\"handshakes\":%lu,\"resumed\":%lu,\"failed\":%lu,"
+                 "\"resume_pct\":%lu,\"ms\":{\"last\":%lu,\"min\":%lu,\"avg\":%lu,\"max\":%lu}}",
+                 (unsigned long)st->handshakes, (unsigned long)st->resumed, (unsigned long)st->failed,
+                 st->handshakes ? (unsigned long)(st->resumed * 100u / st->handshakes) : 0ul,
+                 (unsigned long)st->last_ms, (unsigned long)st->min_ms,
+                 st->handshakes ? (unsigned long)(st->total_ms / st->handshakes) : 0ul,
+                 (unsigned long)st->max_ms);
+ #else
+     page_append(body, sizeof(body), &body_len, "{\"enabled\":false}");
+ #endif
+     char head[128];
+     int head_len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n"
+                             "Cache-Control: no-store\r\nConnection: %s\r\n\r\n",
+                             (unsigned)body_len, keep_alive ? "keep-alive" : "close");
+     const http_fragment_t response[] = {
+          { head, (size_t)head_len, TCP_WRITE_FLAG_COPY },
+          { body, body_len,         TCP_WRITE_FLAG_COPY },
+     };
+     conn->unacked += (u32_t)head_len + body_len;
+     return http_write_fragments(conn->pcb, response, 2);
+ }
+ 
+ // Teste de conectividade: resposta pronta da flash, sem gerar nada
+ static err_t http_send_probe(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     const char *response = PORTAL_REDIRECT_RESPONSE;
+     size_t len = sizeof(PORTAL_REDIRECT_RESPONSE) - 1;
+ #if !CAPTIVE_PORTAL_REDIRECT
+     switch (conn->parser.route) {
+     case ROUTE_PROBE_GENERATE_204:
+     case ROUTE_PROBE_GEN_204:
+          response = PROBE_204_RESPONSE;
+          len = sizeof(PROBE_204_RESPONSE) - 1;
+          break;
+     case ROUTE_PROBE_HOTSPOT:
+     case ROUTE_PROBE_APPLE_SUCCESS:
+          response = PROBE_APPLE_RESPONSE;
+          len = sizeof(PROBE_APPLE_RESPONSE) - 1;
+          break;
+     case ROUTE_PROBE_CONNECTTEST:
+          response = PROBE_CONNECTTEST_RESPONSE;
+          len = sizeof(PROBE_CONNECTTEST_RESPONSE) - 1;
+          break;
+     case ROUTE_PROBE_NCSI:
+          response = PROBE_NCSI_RESPONSE;
+          len = sizeof(PROBE_NCSI_RESPONSE) - 1;
+          break;
+     case ROUTE_PROBE_SUCCESS_TXT:
+          response = PROBE_SUCCESS_TXT_RESPONSE;
+          len = sizeof(PROBE_SUCCESS_TXT_RESPONSE) - 1;
+          break;
+     default:
+          break;  // /redirect: página de login do Windows
+     }
+ #endif
+     conn->unacked += (u32_t)len;
+     return altcp_write(conn->pcb, response, (u16_t)len, 0);
+ }
+ 
+ // Caminho desconhecido (sondagens, erros de digitação): 404 curto em vez da página
+ static err_t http_send_not_found(http_conn_t *conn, bool keep_alive, const http_args_t *args) {
+     conn->unacked += sizeof(HTTP_404_RESPONSE) - 1;
+     return altcp_write(conn->pcb, HTTP_404_RESPONSE, sizeof(HTTP_404_RESPONSE) - 1, 0);
+ }
+ 
+ // Requisição para outro site (o DNS aponta todos os nomes para a placa)
+ static bool http_host_is_foreign(const http_parser_t *req) {
+     if (req->host[0] == '\0') return false;  // HTTP/1.0 sem Host
+     return strcmp(req->host, PORTAL_HOST) != 0 && strcmp(req->host, PORTAL_HOST ":80") != 0 &&
+            strcmp(req->host, PORTAL_HOST ":443") != 0;
+ }
+ 
+ // Tabela de rotas, indexada pelo identificador resolvido em http_resolve_route.
+ // Cada rota aceita um método e declara os parâmetros da query string que o
+ // handler recebe já convertidos (http_args_t).
+ typedef err_t (*http_handler_t)(http_conn_t *conn, bool keep_alive, const http_args_t *args);
+ 
+ static const struct {
+     const char *path;
+     u8_t method;                     // http_method_t aceito
+     u16_t args;                      // ARG_* decodificados para o handler
+     u8_t cost;                       // créditos de rate limit consumidos
+     http_handler_t handler;
+ } http_routes[ROUTE_COUNT] = {
+     [ROUTE_PAGE]   = { ROUTE_PATH_PAGE,   HTTP_METHOD_GET,  ARG_FLOOR | ARG_ACTION | ARG_VALUE | ARG_ZONE | ARG_BADGE, 2, http_send_root },
+     [ROUTE_APP]    = { ROUTE_PATH_APP,    HTTP_METHOD_GET,  0, 1, http_send_app },
+     [ROUTE_APP_JS] = { ROUTE_PATH_APP_JS, HTTP_METHOD_GET,  0, 1, http_send_app_bundle },
+     [ROUTE_FLOORS] = { ROUTE_PATH_FLOORS, HTTP_METHOD_GET,  0, 1, http_send_floors_json },
+     [ROUTE_BATCH]  = { ROUTE_PATH_BATCH,  HTTP_METHOD_POST, 0, 2, http_apply_batch },
+     [ROUTE_EVENTS] = { ROUTE_PATH_EVENTS, HTTP_METHOD_GET,  0, 1, http_start_sse },
+     [ROUTE_WS]     = { ROUTE_PATH_WS,     HTTP_METHOD_GET,  0, 1, http_start_websocket },
+     [ROUTE_TLS]    = { ROUTE_PATH_TLS,    HTTP_METHOD_GET,  0, 1, http_send_tls_stats },
+     [ROUTE_CHECKINS] = { ROUTE_PATH_CHECKINS, HTTP_METHOD_GET, ARG_CURSOR | ARG_LIMIT, 1, http_send_checkins },
+     [ROUTE_SERIES]   = { ROUTE_PATH_SERIES,   HTTP_METHOD_GET, ARG_FLOOR | ARG_RES | ARG_FROM | ARG_TO, 1, http_send_series },
+     [ROUTE_OCCUPANCY] = { ROUTE_PATH_OCCUPANCY, HTTP_METHOD_GET, ARG_FLOOR | ARG_FROM | ARG_TO, 1, http_send_occupancy },
+     [ROUTE_CONFIG]    = { ROUTE_PATH_CONFIG,    HTTP_METHOD_POST, 0, 2, http_apply_config },
+     [ROUTE_PROBE_GENERATE_204]  = { ROUTE_PATH_PROBE_GENERATE_204,  HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_GEN_204]       = { ROUTE_PATH_PROBE_GEN_204,       HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_HOTSPOT]       = { ROUTE_PATH_PROBE_HOTSPOT,       HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_APPLE_SUCCESS] = { ROUTE_PATH_PROBE_APPLE_SUCCESS, HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_CONNECTTEST]   = { ROUTE_PATH_PROBE_CONNECTTEST,   HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_NCSI]          = { ROUTE_PATH_PROBE_NCSI,          HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_REDIRECT]      = { ROUTE_PATH_PROBE_REDIRECT,      HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_PROBE_SUCCESS_TXT]   = { ROUTE_PATH_PROBE_SUCCESS_TXT,   HTTP_METHOD_GET, 0, 0, http_send_probe },
+     [ROUTE_NOT_FOUND]           = { NULL,                           HTTP_METHOD_GET, 0, 1, http_send_not_found },
+ };
+ 
+ // Caminhos de mesmo tamanho, separados pelo segundo (ou sexto) caractere em http_resolve_route
+ _Static_assert(sizeof(ROUTE_PATH_FLOORS) == sizeof(ROUTE_PATH_CONFIG),
+                "rever o switch de http_resolve_route");
+ _Static_assert(sizeof(ROUTE_PATH_PROBE_NCSI) == sizeof(ROUTE_PATH_PROBE_REDIRECT),
+                "rever o switch de http_resolve_route");
+ _Static_assert(sizeof(ROUTE_PATH_PROBE_HOTSPOT) == sizeof(ROUTE_PATH_APP_JS),
+                "rever o switch de http_resolve_route");
+ _Static_assert(sizeof(ROUTE_PATH_PROBE_GEN_204) == sizeof(ROUTE_PATH_TLS),
+                "rever o switch de http_resolve_route");
+ _Static_assert(sizeof(ROUTE_PATH_PROBE_GENERATE_204) == sizeof(ROUTE_PATH_CHECKINS),
+                "rever o switch de http_resolve_route");
+ 
+ // Resolve o caminho com um switch pelo tamanho (os rótulos são calculados em
+ // tempo de compilação; duas rotas de mesmo tamanho geram erro de "case"
+ // duplicado e são separadas por um caractere) e uma única comparação.
+ // Caminhos desconhecidos recebem a página principal.
+ static http_route_id_t http_resolve_route(const http_parser_t *req) {
+     http_route_id_t id;
+     switch (req->path_len) {
+     case sizeof(ROUTE_PATH_PAGE) - 1:   id = ROUTE_PAGE; break;
+     case sizeof(ROUTE_PATH_APP) - 1:    id = ROUTE_APP; break;
+     case sizeof(ROUTE_PATH_FLOORS) - 1:              // == ROUTE_PATH_CONFIG
+          id = (req->path[5] == 'f') ? ROUTE_FLOORS : ROUTE_CONFIG;
+          break;
+     case sizeof(ROUTE_PATH_BATCH) - 1:  id = ROUTE_BATCH; break;
+     case sizeof(ROUTE_PATH_EVENTS) - 1: id = ROUTE_EVENTS; break;
+     case sizeof(ROUTE_PATH_WS) - 1:     id = ROUTE_WS; break;
+     case sizeof(ROUTE_PATH_SERIES) - 1: id = ROUTE_SERIES; break;
+     case sizeof(ROUTE_PATH_OCCUPANCY) - 1: id = ROUTE_OCCUPANCY; break;
+     case sizeof(ROUTE_PATH_PROBE_APPLE_SUCCESS) - 1: id = ROUTE_PROBE_APPLE_SUCCESS; break;
+     case sizeof(ROUTE_PATH_PROBE_CONNECTTEST) - 1:   id = ROUTE_PROBE_CONNECTTEST; break;
+     case sizeof(ROUTE_PATH_PROBE_SUCCESS_TXT) - 1:   id = ROUTE_PROBE_SUCCESS_TXT; break;
+     case sizeof(ROUTE_PATH_PROBE_NCSI) - 1:          // == ROUTE_PATH_PROBE_REDIRECT
+          id = (req->path[1] == 'n') ? ROUTE_PROBE_NCSI : ROUTE_PROBE_REDIRECT;
+          break;
+     case sizeof(ROUTE_PATH_APP_JS) - 1:              // == ROUTE_PATH_PROBE_HOTSPOT
+          id = (req->path[1] == 'a') ? ROUTE_APP_JS : ROUTE_PROBE_HOTSPOT;
+          break;
+     case sizeof(ROUTE_PATH_TLS) - 1:                 // == ROUTE_PATH_PROBE_GEN_204
+          id = (req->path[1] == 'a') ? ROUTE_TLS : ROUTE_PROBE_GEN_204;
+          break;
+     case sizeof(ROUTE_PATH_CHECKINS) - 1:            // == ROUTE_PATH_PROBE_GENERATE_204
+          id = (req->path[1] == 'a') ? ROUTE_CHECKINS : ROUTE_PROBE_GENERATE_204;
+          break;
+     default:
+          return ROUTE_NOT_FOUND;
+     }
+     return (memcmp(req->path, http_routes[id].path, req->path_len) == 0) ? id : ROUTE_NOT_FOUND;
+ }
+ 
+ // Converte os parâmetros da query string pedidos pela rota. Valores inválidos
+ // ficam ausentes (bit correspondente zerado em present).
+ static void http_decode_args(const http_parser_t *req, u16_t wanted, http_args_t *args) {
+     memset(args, 0, sizeof(*args));
+     args->zone = -1;
+     for (u8_t i = 0; i < req->num_params; i++) {
+          const char *key = req->params[i].key;
+          const char *value = req->params[i].value;
+          switch (key[0]) {
+          case 'f':
+               if ((wanted & ARG_FLOOR) && strcmp(key, "floor") == 0 &&
+                   parse_uint(value, building.num_floors - 1, &args->floor)) {
+                    args->present |= ARG_FLOOR;
+               }
+               if ((wanted & ARG_FROM) && strcmp(key, "from") == 0 && parse_uint(value, INT32_MAX, &args->from)) {
+                    args->present |= ARG_FROM;
+               }
+               break;
+          case 'b':
+               if ((wanted & ARG_BADGE) && strcmp(key, "badge") == 0 &&
+                   parse_uint(value, INT32_MAX, &args->badge) && args->badge > 0) {
+                    args->present |= ARG_BADGE;
+               }
+               break;
+          case 'r':
+               if ((wanted & ARG_RES) && strcmp(key, "res") == 0) {
+                    for (int l = 0; l < TIMESERIES_LEVELS; l++) {
+                         if (strcmp(value, series_level_names[l]) == 0) {
+                              args->res = (timeseries_level_t)l;
+                              args->present |= ARG_RES;
+                         }
+                    }
+               }
+               break;
+          case 't':
+               if ((wanted & ARG_TO) && strcmp(key, "to") == 0 && parse_uint(value, INT32_MAX, &args->to)) {
+                    args->present |= ARG_TO;
+               }
+               break;
+          case 'a':
+               if ((wanted & ARG_ACTION) && strcmp(key, "action") == 0 &&
+                   (args->action = parse_action(value)) != ACTION_NONE) {
+                    args->present |= ARG_ACTION;
+               }
+               break;
+          case 'v':
+               if ((wanted & ARG_VALUE) && strcmp(key, "value") == 0 &&
+                   parse_uint(value, INT16_MAX, &args->value)) {
+                    args->present |= ARG_VALUE;
+               }
+               break;
+          case 'c':
+               if ((wanted & ARG_CURSOR) && strcmp(key, "cursor") == 0 &&
+                   parse_uint(value, INT32_MAX, &args->cursor)) {
+                    args->present |= ARG_CURSOR;
+               }
+               break;
+          case 'l':
+               if ((wanted & ARG_LIMIT) && strcmp(key, "limit") == 0 &&
+                   parse_uint(value, CHECKINS_PAGE_MAX, &args->limit) && args->limit > 0) {
+                    args->present |= ARG_LIMIT;
+               }
+               break;
+          case 'z':
+               if ((wanted & ARG_ZONE) && strcmp(key, "zone") == 0 &&
+                   parse_uint(value, BUILDING_MAX_ZONES - 1, &args->zone)) {
+                    args->present |= ARG_ZONE;
+               }
+               break;
+          default:
+               break;
+          }
+     }
+ }
+ 
+ // Trata uma requisição já analisada pelo parser e enfileira a resposta
+ static err_t http_handle_request(http_conn_t *conn) {
+     http_parser_t *req = &conn->parser;
+     
+     // Fora das sondagens, endereços de outros sites vão para o portal
+     if (http_routes[req->route].handler != http_send_probe && http_host_is_foreign(req)) {
+          req->route = ROUTE_PROBE_REDIRECT;
+     }
+     if (req->method != http_routes[req->route].method) {
+          req->status = 405;
+          return http_send_error(conn);
+     }
+     
+     bool keep_alive = req->keep_alive;
+     conn->requests++;
+     if (conn->requests >= HTTP_KEEPALIVE_MAX_REQUESTS) keep_alive = false;
+     if (!keep_alive) conn->close_after_send = true;
+     
+     // Cliente acima do limite: resposta constante da flash, sem executar a rota
+     if (!rate_limit_take(conn->client, http_routes[req->route].cost)) {
+          conn->unacked += sizeof(HTTP_429_RESPONSE) - 1;
+          return altcp_write(conn->pcb, HTTP_429_RESPONSE, sizeof(HTTP_429_RESPONSE) - 1, 0);
+     }
+     
+     http_args_t args;
+     http_decode_args(req, http_routes[req->route].args, &args);
+     return http_routes[req->route].handler(conn, keep_alive, &args);
+ }
+ 
+ // Responde a uma requisição malformada com o status indicado pelo parser e
+ // descarta o que mais tiver chegado nesta conexão
+ static err_t http_send_error(http_conn_t *conn) {
+     static const struct {
+          u16_t status;
+          const char *response;
+          size_t len;
+     } errors[] = {
+          { 404, HTTP_404_CLOSE_RESPONSE, sizeof(HTTP_404_CLOSE_RESPONSE) - 1 },
+          { 405, HTTP_405_RESPONSE, sizeof(HTTP_405_RESPONSE) - 1 },
+          { 411, HTTP_411_RESPONSE, sizeof(HTTP_411_RESPONSE) - 1 },
+          { 413, HTTP_413_RESPONSE, sizeof(HTTP_413_RESPONSE) - 1 },
+          { 414, HTTP_414_RESPONSE, sizeof(HTTP_414_RESPONSE) - 1 },
+          { 431, HTTP_431_RESPONSE, sizeof(HTTP_431_RESPONSE) - 1 },
+          { 503, HTTP_503_RESPONSE, sizeof(HTTP_503_RESPONSE) - 1 },
+     };
+     const char *msg = HTTP_400_RESPONSE;
+     size_t len = sizeof(HTTP_400_RESPONSE) - 1;
+     for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
+          if (errors[i].status == conn->parser.status) {
+               msg = errors[i].response;
+               len = errors[i].len;
+          }
+     }
+     if (conn->pending) {
+          altcp_recved(conn->pcb, conn->pending->tot_len);
+          pbuf_free(conn->pending);
+          conn->pending = NULL;
+     }
+     conn->close_after_send = true;
+     conn->unacked += len;
+     return altcp_write(conn->pcb, msg, len, 0);
+ }
+ 
+ // Alimenta o parser com os pbufs pendentes, direto dos payloads (sem cópia).
+ // Os bytes consumidos são liberados e devolvidos à janela TCP.
+ static http_parse_result_t http_feed_pending(http_conn_t *conn) {
+     http_parse_result_t result = HTTP_PARSE_INCOMPLETE;
+     size_t total = 0;
+     for (struct pbuf *q = conn->pending; q != NULL; q = q->next) {
+          size_t used;
+          result = http_parser_feed(&conn->parser, (const char *)q->payload, q->len, &used);
+          total += used;
+          if (result != HTTP_PARSE_INCOMPLETE) break;
+     }
+     if (total > 0) {
+          conn->pending = pbuf_free_header(conn->pending, (u16_t)total);
+          altcp_recved(conn->pcb, (u16_t)total);
+     }
+     return result;
+ }
+ 
+ // Processa, em ordem, todas as requisições completas já recebidas (pipelining).
+ // Se o buffer de envio não comportar outra resposta, o restante fica para
+ // quando o lwIP confirmar os dados pendentes (sent_callback). Enquanto isso os
+ // bytes não lidos seguram a janela TCP, o que limita o cliente naturalmente.
+ static err_t http_process_requests(http_conn_t *conn) {
+     struct altcp_pcb *tpcb = conn->pcb;
+     bool wrote = false;
+     err_t err = ERR_OK;
+     while (conn->mode == CONN_HTTP) {
+          // Página ainda em envio: termina antes de responder a próxima requisição
+          if (conn->page.active) {
+               err = http_stream_page(conn);
+               wrote = true;
+               if (err != ERR_OK || conn->page.active) break;
+          }
+          if (conn->close_after_send) break;
+          
+          http_parse_result_t result = http_feed_pending(conn);
+          if (result == HTTP_PARSE_INCOMPLETE) break;  // aguarda mais dados
+          if (conn->in_backlog) {
+               // Primeira requisição chegou: libera a vaga no backlog do listener
+               tcp_backlog_accepted(http_tcp_pcb(tpcb));
+               conn->in_backlog = false;
+          }
+          
+          // POST: lê o corpo (lote) antes de responder
+          if (result == HTTP_PARSE_COMPLETE && !conn->parser.route) {
+               conn->parser.route = http_resolve_route(&conn->parser);
+          }
+          if (result == HTTP_PARSE_COMPLETE && conn->parser.method == HTTP_METHOD_POST) {
+               if (!conn->batch.active && !batch_begin(conn)) {
+                    result = HTTP_PARSE_ERROR;
+               } else if (!batch_feed_pending(conn)) {
+                    break;  // aguarda o resto do corpo
+               }
+          }
+          
+          if (result == HTTP_PARSE_ERROR) {
+               err = http_send_error(conn);
+          } else {
+               if (altcp_sndbuf(tpcb) < HTTP_MIN_SNDBUF_PER_RESPONSE ||
+                   altcp_sndqueuelen(tpcb) + 8 > TCP_SND_QUEUELEN) {
+                    break;
+               }
+               err = http_handle_request(conn);
+               conn->batch.active = false;  // corpo consumido mesmo sem executar a rota (429)
+               if (conn->mode == CONN_HTTP) http_parser_reset(&conn->parser);
+          }
+          wrote = true;
+          if (err != ERR_OK) break;
+     }
+     if (conn->pcb == NULL) return conn->close_err;  // fechada durante o processamento
      if (err != ERR_OK) {
-          printf("Erro ao fechar conexao (err=%d), abortando.\n", err);
-          tcp_abort(tpcb);
+          // Resposta parcial pode estar na fila: aborta em vez de enviar HTML truncado
+          printf("Erro ao escrever a resposta (err=%d), abortando conexao.\n", err);
+          if (conn->pending) pbuf_free(conn->pending);
+          conn->pending = NULL;
+          conn->pcb = NULL;
+          altcp_arg(tpcb, NULL);
+          altcp_abort(tpcb);
+          return ERR_ABRT;
      }
+     if (wrote) altcp_output(tpcb);
+     // Frames enviados logo após o handshake podem já estar na fila
+     if (conn->mode == CONN_WS) return ws_process_frames(conn);
      return ERR_OK;
  }
-  
- // Callback HTTP: processa a requisição GET e atualiza a ocupação se os parâmetros estiverem presentes
- static err_t http_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-     if (p == NULL) {
-          tcp_close(tpcb);
+ 
+ // Callback chamada quando o cliente confirma dados enviados. Continua a página
+ // em envio, retoma requisições enfileiradas ou fecha a conexão se a última
+ // resposta pedia "Connection: close".
+ static err_t sent_callback(void *arg, struct altcp_pcb *tpcb, u16_t len) {
+     http_conn_t *conn = (http_conn_t *)arg;
+     if (!conn) return ERR_OK;
+     conn->idle_ticks = 0;
+     conn->stall_ticks = 0;
+     conn->unacked = (len >= conn->unacked) ? 0 : conn->unacked - len;
+     if (conn->close_after_send && !conn->page.active) {
+          if (conn->unacked == 0) return http_conn_close(conn);
           return ERR_OK;
      }
-     char request[1024] = {0};
-     size_t copy_len = (p->tot_len < sizeof(request)-1) ? p->tot_len : sizeof(request)-1;
-     memcpy(request, p->payload, copy_len);
-     request[copy_len] = '\0';
-     tcp_recved(tpcb, p->tot_len);
+     return http_process_requests(conn);
+ }
   
-     char line[256] = {0};
-     char *token = strtok(request, "\r\n");
-     if (token) {
-          strncpy(line, token, sizeof(line)-1);
-     } else {
-          pbuf_free(p);
-          return ERR_OK;
+ // Callback HTTP: acumula os bytes recebidos e processa as requisições completas
+ static err_t http_callback(void *arg, struct altcp_pcb *tpcb, struct pbuf *p, err_t err) {
+     http_conn_t *conn = (http_conn_t *)arg;
+     if (p == NULL) {
+          // Cliente encerrou a conexão
+          if (!conn) {
+               altcp_close(tpcb);
+               return ERR_OK;
+          }
+          return http_conn_close(conn);
      }
-     if (strncmp(line, "GET", 3) != 0) {
+ #if HTTPS_ENABLED
+     // O altcp_tls só entrega dados decifrados: os primeiros fecham o handshake
+     if (conn && conn->tls) tls_server_handshake_done(&conn->tls_state, to_ms_since_boot(get_absolute_time()));
+ #endif
+     if (!conn || conn->close_after_send || conn->mode == CONN_SSE) {
+          // Resposta final já enviada (ou conexão /events): descarta dados adicionais
+          altcp_recved(tpcb, p->tot_len);
           pbuf_free(p);
           return ERR_OK;
      }
-    
-     char floor_str[8] = "";
-     char action[16] = "";
-     char value_str[8] = "";
-     parse_query_params(line, floor_str, sizeof(floor_str), action, sizeof(action), value_str, sizeof(value_str));
-     if (floor_str[0] != '\0' && strcmp(action, "clear_all") != 0) {
-          selected_floor = atoi(floor_str);
-     }
-     if (action[0] != '\0') {
-          update_occupancy(floor_str, action, value_str);
-     }
-    
-     char response[2048] = {0};
-     create_html_page(response, sizeof(response));
-     err_t write_err = tcp_write(tpcb, response, strlen(response), TCP_WRITE_FLAG_COPY);
-     if (write_err == ERR_OK) {
-          tcp_sent(tpcb, sent_callback);
-          tcp_output(tpcb);
-     } else {
-          printf("Erro ao escrever a resposta (err=%d), fechando conexao.\n", write_err);
-          tcp_close(tpcb);
+     conn->idle_ticks = 0;
+     // Mantém a cadeia de pbufs; o parser lê os payloads diretamente
+     if (conn->pending) pbuf_cat(conn->pending, p);
+     else conn->pending = p;
+     return http_process_requests(conn);
+ }
+ 
+ // Requisição começou a chegar mas ainda não foi respondida
+ static bool http_request_in_progress(const http_conn_t *conn) {
+     return conn->pending != NULL || conn->parser.header_bytes > 0 || conn->batch.active;
+ }
+ 
+ // Chamada periodicamente pelo lwIP; encerra conexões paradas ou ociosas
+ static err_t http_poll_callback(void *arg, struct altcp_pcb *tpcb) {
+     http_conn_t *conn = (http_conn_t *)arg;
+     if (!conn) return ERR_OK;
+     conn->idle_ticks++;
+     conn->stall_ticks = (conn->unacked > 0) ? conn->stall_ticks + 1 : 0;
+     if (conn->stall_ticks >= HTTP_POLL_TICKS(HTTP_SEND_TIMEOUT_S)) {
+          // Cliente parou de confirmar dados (sumiu do AP ou não lê o socket)
+          printf("Cliente sem ACK ha %ds, abortando conexao.\n", HTTP_SEND_TIMEOUT_S);
+          if (conn->pending) pbuf_free(conn->pending);
+          conn->pending = NULL;
+          conn->pcb = NULL;
+          altcp_arg(tpcb, NULL);
+          altcp_abort(tpcb);
+          return ERR_ABRT;
+     }
+     if (conn->mode != CONN_HTTP || conn->close_after_send) return ERR_OK;  // eventos: heartbeat
+     if (http_request_in_progress(conn) && conn->idle_ticks >= HTTP_POLL_TICKS(HTTP_REQUEST_TIMEOUT_S)) {
+          printf("Requisicao incompleta apos %ds, encerrando.\n", HTTP_REQUEST_TIMEOUT_S);
+          return http_conn_close(conn);
+     }
+     if (conn->idle_ticks >= HTTP_POLL_TICKS(HTTP_KEEPALIVE_TIMEOUT_S)) {
+          printf("Conexao ociosa encerrada.\n");
+          return http_conn_close(conn);
      }
-     pbuf_free(p);
      return ERR_OK;
  }
-  
- static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err) {
-     tcp_recv(newpcb, http_callback);
+ 
+ // Chamada pelo lwIP quando o PCB já foi liberado (RST, falha de memória...)
+ static void http_err_callback(void *arg, err_t err) {
+     http_conn_t *conn = (http_conn_t *)arg;
+     if (!conn) return;
+     if (conn->pending) {
+          pbuf_free(conn->pending);
+          conn->pending = NULL;
+     }
+ #if HTTPS_ENABLED
+     if (conn->tls) tls_server_closed(&conn->tls_state);
+ #endif
+     conn->pcb = NULL;
+ }
+ 
+
+ // Escolhe a conexão keep-alive ociosa há mais tempo (sem requisição em
+ // andamento nem dados sem ACK) para ceder a vaga a um cliente novo. Com
+ // tls_only, só conexões HTTPS (para respeitar HTTPS_MAX_CONNECTIONS).
+ static http_conn_t *http_find_evictable(bool tls_only) {
+     http_conn_t *victim = NULL;
+     for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+          http_conn_t *c = &http_conns[i];
+          if (c->pcb == NULL || (tls_only && !c->tls) || c->mode != CONN_HTTP || c->close_after_send ||
+              c->unacked > 0 || c->page.active || http_request_in_progress(c)) {
+               continue;
+          }
+          if (!victim || c->idle_ticks > victim->idle_ticks) victim = c;
+     }
+     return victim;
+ }
+ 
+ // Admissão: usa uma posição livre do pool ou despeja a conexão ociosa mais
+ // antiga; se todas estiverem ocupadas de fato, recusa com RST imediato, que
+ // não segura PCB nem memória (o navegador tenta de novo).
+ static err_t connection_callback(void *arg, struct altcp_pcb *newpcb, err_t err) {
+     if (err != ERR_OK || newpcb == NULL) return ERR_VAL;
+     bool tls = (arg != NULL);        // listener HTTPS (ver start_https_server)
+     http_conn_t *conn = NULL;
+     int tls_count = 0;
+     for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+          if (http_conns[i].pcb == NULL) {
+               if (!conn) conn = &http_conns[i];
+          } else if (http_conns[i].tls) {
+               tls_count++;
+          }
+     }
+     if (tls && tls_count >= HTTPS_MAX_CONNECTIONS) {
+          // Vagas TLS esgotadas: só entra no lugar de outra conexão TLS ociosa
+          conn = http_find_evictable(true);
+          if (conn) {
+               printf("Limite HTTPS atingido, encerrando conexao TLS ociosa.\n");
+               http_conn_close(conn);
+          }
+     } else if (!conn && (conn = http_find_evictable(false)) != NULL) {
+          printf("Pool cheio, encerrando conexao ociosa para novo cliente.\n");
+          http_conn_close(conn);
+     }
+     if (!conn) {
+          printf("Limite de conexoes atingido, recusando cliente.\n");
+          altcp_abort(newpcb);
+          return ERR_ABRT;
+     }
+     memset(conn, 0, sizeof(*conn));
+     conn->pcb = newpcb;
+     // Até a primeira requisição a conexão ocupa uma vaga do backlog: com o
+     // backlog cheio o lwIP ignora novos SYNs e os clientes retransmitem depois
+     tcp_backlog_delayed(http_tcp_pcb(newpcb));
+     conn->in_backlog = true;
+     conn->client = rate_limit_slot(altcp_get_ip(newpcb, 0));
+ #if HTTPS_ENABLED
+     if (tls) {
+          conn->tls = true;
+          tls_server_accepted(newpcb, &conn->tls_state, to_ms_since_boot(get_absolute_time()));
+     }
+ #endif
+     http_parser_reset(&conn->parser);
+     altcp_arg(newpcb, conn);
+     altcp_recv(newpcb, http_callback);
+     altcp_sent(newpcb, sent_callback);
+     altcp_poll(newpcb, http_poll_callback, HTTP_POLL_INTERVAL);
+     altcp_err(newpcb, http_err_callback);
      return ERR_OK;
  }
   
  static void start_http_server(void) {
-     struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+     boot_id = get_rand_32();
+     struct altcp_pcb *pcb = altcp_tcp_new_ip_type(IPADDR_TYPE_ANY);
      if (!pcb) {
           printf("Erro ao criar PCB\n");
           return;
      }
-     if (tcp_bind(pcb, IP_ANY_TYPE, HTTP_PORT) != ERR_OK) {
+     if (altcp_bind(pcb, IP_ANY_TYPE, HTTP_PORT) != ERR_OK) {
           printf("Erro ao ligar o servidor na porta %d\n", HTTP_PORT);
           return;
      }
-     pcb = tcp_listen(pcb);
-     tcp_accept(pcb, connection_callback);
+     pcb = altcp_listen_with_backlog(pcb, HTTP_LISTEN_BACKLOG);
+     altcp_accept(pcb, connection_callback);
      printf("Servidor HTTP rodando na porta %d...\n", HTTP_PORT);
  }
+ 
+ #if HTTPS_ENABLED
+ // Listener HTTPS: mesmo servidor, com a camada altcp_tls por baixo. O arg do
+ // listener (não nulo) marca as conexões aceitas por ele como TLS.
+ static void start_https_server(void) {
+     static u8_t https_listener_tag;
+     struct altcp_pcb *pcb = tls_server_new();
+     if (!pcb) {
+          printf("Erro ao criar PCB TLS (certificado/chave invalidos?)\n");
+          return;
+     }
+     if (altcp_bind(pcb, IP_ANY_TYPE, HTTPS_PORT) != ERR_OK) {
+          printf("Erro ao ligar o servidor na porta %d\n", HTTPS_PORT);
+          return;
+     }
+     pcb = altcp_listen_with_backlog(pcb, HTTP_LISTEN_BACKLOG);
+     altcp_arg(pcb, &https_listener_tag);
+     altcp_accept(pcb, connection_callback);
+     printf("Servidor HTTPS rodando na porta %d...\n", HTTPS_PORT);
+ }
+ #endif
   
  /* ─── FUNÇÕES PARA A MATRIZ DE LED WS2812 ───────────────────────────── */
  // Envia a cor para um LED WS2812 (dados no formato GRB, deslocados 8 bits à esquerda)
@@ -369,36 +2780,43 @@
  static inline uint32_t urgb_u32(uint8_t r, uint8_t g, uint8_t b) {
      return ((uint32_t)r << 8) | ((uint32_t)g << 16) | (uint32_t)b;
  }
- // Atualiza a matriz de LED WS2812 (5x5)
-// Cada LED equivale a 10 pessoas.
+ // Atualiza a matriz de LED WS2812 (5x5): uma linha por andar, mostrando os 5
+// andares do grupo que contém o andar selecionado. Cada LED equivale a 1/5 da
+// capacidade do andar (10 pessoas com a capacidade padrão de 50).
 
-void update_led_matrix(void) {
+void update_led_matrix(const occupancy_snapshot_t *s) {
     uint32_t pixels[25];
-    for (int floor = 0; floor < NUM_FLOORS; floor++) {
+    int first = (s->selected / 5) * 5;
+    for (int row = 0; row < 5; row++) {
+        int floor = first + row;
+        uint32_t count = 0, per_led = 1;
+        if (floor < building.num_floors) {
+            count = s->floor_count[floor];
+            per_led = building.floors[floor].capacity / 5;
+            if (per_led == 0) per_led = 1;
+        }
         uint8_t leds_lit = 0;
-        // Se há ocupação entre 1 e 9, acende apenas 1 LED (light blue).
-        if (occupancy[floor] > 0 && occupancy[floor] < 10) {
-            leds_lit = 1;
-        } else if (occupancy[floor] >= 10) {
-            leds_lit = occupancy[floor] / 10;
-            if (leds_lit > 5) leds_lit = 5;
+        // Se há ocupação abaixo de um LED, acende apenas 1 LED (verde).
+        bool few = count > 0 && count < per_led;
+        if (count >= per_led) {
+            leds_lit = (count / per_led > 5) ? 5 : (uint8_t)(count / per_led);
         }
         for (int col = 0; col < 5; col++) {
             int index;
-            // Para pisos pares, inverte a ordem dos LEDs na linha.
-            if (floor % 2 == 0) {
-                index = floor * 5 + (4 - col);
+            // Para linhas pares, inverte a ordem dos LEDs na linha.
+            if (row % 2 == 0) {
+                index = row * 5 + (4 - col);
             } else {
-                index = floor * 5 + col;
+                index = row * 5 + col;
             }
-            if (occupancy[floor] > 0 && occupancy[floor] < 10) {
+            if (few) {
                 // Apenas o primeiro LED (na ordem definida) aceso em verde.
                 if (col == 0)
                     pixels[index] = urgb_u32(0, 5, 0); // green
                 else
                     pixels[index] = urgb_u32(0, 0, 0);
             } else {
-                // Para ocupações ≥10, acende os primeiros 'leds_lit' LEDs em vermelho.
+                // Acende os primeiros 'leds_lit' LEDs em vermelho.
                 if (col < leds_lit)
                     pixels[index] = urgb_u32(5, 0, 0); // vermelho
                 else
@@ -412,6 +2830,30 @@ void update_led_matrix(void) {
     }
     sleep_us(50);
 }
+
+ /* ─── RENDERIZAÇÃO NO CORE1 ──────────────────────────────────────────── */
+ // O OLED (I2C bloqueante, ~1 KB por quadro) e a matriz (PIO + sleep_us)
+ // ficam no core1, para que as callbacks do lwIP e os botões no core0 só
+ // enfileirem um pedido e retornem. O core1 copia o estado (take_snapshot) na
+ // hora de desenhar, então pedidos acumulados viram um único quadro e um pedido
+ // descartado com a fila cheia não perde nada (ainda há outro na fila).
+ // A FIFO entre os cores não é usada: flash_safe_execute precisa dela para
+ // pausar o core1 enquanto a flash é gravada (ver flash_store.c).
+ static void request_render(uint32_t what) {
+     queue_try_add(&render_queue, &what);
+ }
+
+ static void render_core1_main(void) {
+     flash_safe_execute_core_init();
+     while (true) {
+          uint32_t what, more;
+          queue_remove_blocking(&render_queue, &what);
+          while (queue_try_remove(&render_queue, &more)) what |= more;
+          take_snapshot(&render_snapshot);
+          if (what & RENDER_OLED) update_oled_display(&render_snapshot);
+          if (what & RENDER_MATRIX) update_led_matrix(&render_snapshot);
+     }
+ }
   
  /* ─── FUNÇÃO PRINCIPAL ───────────────────────────────────────────── */
  int main() {
@@ -419,6 +2861,50 @@ void update_led_matrix(void) {
      sleep_ms(10000);  // Aguarda 10s para estabilidade
      printf("Iniciando sistema!\n");
   
+     /* Carrega o modelo do prédio (enviado por /api/config ou building_config.h) */
+     // Configuração enviada por POST /api/config (flash) ou, sem ela, a do build
+     const char *config = config_store_load();
+     unsigned config_line;
+     if (config && !building_load(&building, config, &config_line)) {
+          printf("Configuracao gravada invalida (linha %u), usando a do build.\n", config_line);
+          config = NULL;
+     }
+     if (!config && !building_load(&building, BUILDING_CONFIG, &config_line)) {
+          printf("Configuracao do predio invalida (linha %u), usando um andar.\n", config_line);
+          building_load(&building, "floor Terreo", &config_line);
+     }
+     printf("Predio: %u andares, %u zonas\n", building.num_floors, building.num_zones);
+     presence_init(&presence, PRESENCE_TTL_MIN);
+     if (!alerts_load(&alerts, ALERT_CONFIG, building.num_floors, &config_line)) {
+          printf("Regras de alerta invalidas (linha %u), alertas desativados.\n", config_line);
+     }
+
+     /* Recupera a ocupação salva na flash (snapshot + alterações posteriores) */
+     uint32_t restore_us = time_us_32();
+     bool restored = flash_store_init(&occupancy_store, zone_saved, building.num_zones,
+                                      flash_store_hash(building.source, strlen(building.source)));
+     memcpy(building.zone_count, zone_saved, building.num_zones * sizeof(zone_saved[0]));
+     building_recount(&building);
+     restore_us = time_us_32() - restore_us;
+     uint16_t floor_counts[BUILDING_MAX_FLOORS];
+     for (int f = 0; f < building.num_floors; f++) {
+          floor_counts[f] = building.floors[f].count > UINT16_MAX ? UINT16_MAX : (uint16_t)building.floors[f].count;
+     }
+     uint32_t boot_s = uptime_s();
+     timeseries_init(&occupancy_series, building.num_floors, boot_s, floor_counts);
+     minute_index_init(&minute_index, building.num_floors, boot_s, floor_counts);
+     // Alertas da ocupação recuperada: ainda não há assinantes, só o console
+     for (int f = 0; f < building.num_floors; f++) alerts_update(&alerts, (uint8_t)f, building.floors[f].count, boot_s);
+     publish_alerts();
+     if (!occupancy_store.enabled) {
+          printf("Flash: regiao reservada sobreposta ao programa, ocupacao nao sera salva\n");
+     } else if (restored) {
+          printf("Flash: ocupacao recuperada (setor %u, %lu alteracoes) em %lu us\n", occupancy_store.sector,
+                 (unsigned long)occupancy_store.replayed, (unsigned long)restore_us);
+     } else {
+          printf("Flash: nenhum estado salvo para esta configuracao, ocupacao zerada\n");
+     }
+  
      /* Inicializa o Wi‑Fi */
      if (cyw43_arch_init()) {
           printf("Erro ao inicializar o Wi-Fi\n");
@@ -460,20 +2946,31 @@ void update_led_matrix(void) {
      /* Teste inicial: exibe um texto de teste por 5 segundos */
      mostrar_mensagem("Iniciando sistema!", 0, 0, true);
      sleep_ms(5000);
-     // Após o teste, exibe o status inicial (ocupação 0)
-     update_oled_display();
+     // Após o teste, exibe o status inicial (ocupação recuperada da flash)
+     take_snapshot(&render_snapshot);
+     update_oled_display(&render_snapshot);
   
      /* Inicializa a matriz de LED WS2812 via PIO */
      pio_ws = pio0;
      sm_ws = pio_claim_unused_sm(pio_ws, true);
      offset_ws = pio_add_program(pio_ws, &ws2812_program);
      ws2812_program_init(pio_ws, sm_ws, offset_ws, WS2812_PIN, 800000, IS_RGBW);
-     update_led_matrix();
+     update_led_matrix(&render_snapshot);
+
+     /* A partir daqui OLED e matriz só são desenhados pelo core1 */
+     queue_init(&render_queue, sizeof(uint32_t), RENDER_QUEUE_DEPTH);
+     multicore_launch_core1(render_core1_main);
   
      /* Inicia o servidor HTTP */
      start_http_server();
+ #if HTTPS_ENABLED
+     start_https_server();
+ #endif
   
      /* Loop principal: Processa tarefas do Wi-Fi e atualiza a seleção via botões */
+     absolute_time_t next_heartbeat = make_timeout_time_ms(SSE_HEARTBEAT_MS);
+     absolute_time_t next_flush = make_timeout_time_ms(FLASH_STORE_FLUSH_MS);
+     absolute_time_t next_sweep = make_timeout_time_ms(PRESENCE_SWEEP_MS);
      while (true) {
           #if PICO_CYW43_ARCH_POLL
                cyw43_arch_poll();
@@ -482,6 +2979,44 @@ void update_led_matrix(void) {
                sleep_ms(100);
           #endif
                update_floor_selection();
+               if (alerts_due(&alerts, uptime_s())) {
+                    cyw43_arch_lwip_begin();
+                    check_alert_deadlines();
+                    cyw43_arch_lwip_end();
+               }
+               if (time_reached(next_heartbeat)) {
+                    cyw43_arch_lwip_begin();
+                    events_heartbeat();
+                    cyw43_arch_lwip_end();
+                    next_heartbeat = make_timeout_time_ms(SSE_HEARTBEAT_MS);
+               }
+               if (time_reached(next_sweep)) {
+                    cyw43_arch_lwip_begin();
+                    expire_badges();
+                    cyw43_arch_lwip_end();
+                    next_sweep = make_timeout_time_ms(PRESENCE_SWEEP_MS);
+               }
+               // Grava as alterações acumuladas (o XIP fica parado durante a gravação)
+               if (time_reached(next_flush)) {
+                    cyw43_arch_lwip_begin();
+                    if (!flash_store_flush(&occupancy_store)) printf("Flash: falha ao gravar a ocupacao\n");
+                    cyw43_arch_lwip_end();
+                    next_flush = make_timeout_time_ms(FLASH_STORE_FLUSH_MS);
+               }
+               // Configuração nova do prédio: grava fora das callbacks e reinicia para carregá-la
+               if (config_upload.ready && time_reached(config_upload.deadline)) {
+                    cyw43_arch_lwip_begin();
+                    flash_store_flush(&occupancy_store);
+                    bool saved = config_store_save(config_upload.text, config_upload.len);
+                    cyw43_arch_lwip_end();
+                    if (saved) {
+                         printf("Configuracao do predio gravada, reiniciando.\n");
+                         watchdog_reboot(0, 0, 0);
+                         while (true) tight_loop_contents();
+                    }
+                    printf("Flash: falha ao gravar a configuracao\n");
+                    config_upload.ready = false;
+               }
           }
   
      cyw43_arch_deinit();
@@ -0,0 +1,81 @@
+# Compacta um arquivo estático com gzip e gera um cabeçalho C com o conteúdo
+# como array constante (fica na flash), no mesmo esquema do cabeçalho que o
+# pioasm gera em generated/.
+#
+# Uso:
+#   cmake -DINPUT=<arquivo> -DOUTPUT=<cabecalho.h> -DNAME=<identificador> -P embed_asset.cmake
+#
+# Gera:
+#   static const uint8_t <NAME>_gz[]     conteúdo comprimido
+#   #define <NAME>_GZ_LEN                tamanho comprimido
+#   #define <NAME>_VERSION               hash do conteúdo original (para URLs versionadas)
+#   #define <NAME>_ETAG                  o mesmo hash entre aspas, como ETag
+#
+# Requer CMake >= 3.19 (file(ARCHIVE_CREATE ... FORMAT raw COMPRESSION GZip)).
+
+cmake_minimum_required(VERSION 3.19)
+
+foreach(var INPUT OUTPUT NAME)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "embed_asset.cmake: ${var} nao definido")
+    endif()
+endforeach()
+
+# FORMAT raw grava só o conteúdo do arquivo, comprimido como um .gz comum
+set(gz_file ${OUTPUT}.gz)
+file(ARCHIVE_CREATE OUTPUT ${gz_file} PATHS ${INPUT} FORMAT raw COMPRESSION GZip COMPRESSION_LEVEL 9)
+file(READ ${gz_file} hex HEX)
+file(REMOVE ${gz_file})
+
+# Zera o MTIME (bytes 4-7) e fixa o campo OS (byte 9) do cabeçalho gzip para
+# que o arquivo gerado não mude a cada build nem entre sistemas operacionais
+string(SUBSTRING "${hex}" 0 8 gz_magic)
+string(SUBSTRING "${hex}" 16 2 gz_xfl)
+string(SUBSTRING "${hex}" 20 -1 gz_rest)
+set(hex "${gz_magic}00000000${gz_xfl}ff${gz_rest}")
+
+string(LENGTH "${hex}" hex_len)
+math(EXPR gz_len "${hex_len} / 2")
+file(SHA1 ${INPUT} content_hash)
+string(SUBSTRING "${content_hash}" 0 12 etag)
+string(TOUPPER ${NAME} upper_name)
+
+# Um byte por "0xNN, ", 16 por linha
+set(bytes "")
+math(EXPR last "${gz_len} - 1")
+foreach(i RANGE ${last})
+    math(EXPR pos "${i} * 2")
+    string(SUBSTRING "${hex}" ${pos} 2 byte)
+    math(EXPR col "${i} % 16")
+    if(i EQUAL 0)
+        string(APPEND bytes "0x${byte}")
+    elseif(col EQUAL 0)
+        string(APPEND bytes ",\n    0x${byte}")
+    else()
+        string(APPEND bytes ", 0x${byte}")
+    endif()
+endforeach()
+get_filename_component(input_name ${INPUT} NAME)
+
+file(WRITE ${OUTPUT}.tmp
+"// ------------------------------------------------------------- //
+// This file is autogenerated by embed_asset.cmake; do not edit! //
+// ------------------------------------------------------------- //
+
+#pragma once
+
+#include <stdint.h>
+
+// ${input_name} (gzip)
+#define ${upper_name}_GZ_LEN ${gz_len}
+#define ${upper_name}_VERSION \"${etag}\"
+#define ${upper_name}_ETAG \"\\\"${etag}\\\"\"
+
+static const uint8_t ${NAME}_gz[${upper_name}_GZ_LEN] = {
+    ${bytes}
+};
+")
+
+# Só substitui o cabeçalho se o conteúdo mudou (evita recompilar à toa)
+configure_file(${OUTPUT}.tmp ${OUTPUT} COPYONLY)
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,46 @@
+# Gera um cabeçalho C com o certificado e a chave do servidor HTTPS (PEM) como
+# strings constantes. O cabeçalho vai para o diretório de build, e não para
+# generated/, porque contém a chave privada.
+#
+# Uso:
+#   cmake -DCERT=<server.crt> -DKEY=<server.key> -DOUTPUT=<tls_cert.h> -P embed_pem.cmake
+#
+# Gera:
+#   static const char TLS_SERVER_CERT[]  certificado (PEM, com '\0' final)
+#   static const char TLS_SERVER_KEY[]   chave privada (PEM, com '\0' final)
+
+cmake_minimum_required(VERSION 3.13)
+
+foreach(var CERT KEY OUTPUT)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "embed_pem.cmake: ${var} nao definido")
+    endif()
+endforeach()
+
+# Uma linha do PEM por linha do C: "-----BEGIN ...-----\n"
+function(pem_to_c_string file out_var)
+    file(STRINGS ${file} lines)
+    set(str "")
+    foreach(line IN LISTS lines)
+        string(APPEND str "\n    \"${line}\\n\"")
+    endforeach()
+    set(${out_var} "${str}" PARENT_SCOPE)
+endfunction()
+
+pem_to_c_string(${CERT} cert_str)
+pem_to_c_string(${KEY} key_str)
+
+file(WRITE ${OUTPUT}.tmp
+"// ----------------------------------------------------------- //
+// This file is autogenerated by embed_pem.cmake; do not edit! //
+// ----------------------------------------------------------- //
+
+#pragma once
+
+static const char TLS_SERVER_CERT[] =${cert_str};
+
+static const char TLS_SERVER_KEY[] =${key_str};
+")
+
+configure_file(${OUTPUT}.tmp ${OUTPUT} COPYONLY)
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,111 @@
+// ------------------------------------------------------------- //
+// This file is autogenerated by embed_asset.cmake; do not edit! //
+// ------------------------------------------------------------- //
+
+#pragma once
+
+#include <stdint.h>
+
+// app.js (gzip)
+#define WEB_APP_GZ_LEN 1522
+#define WEB_APP_VERSION "756692df4709"
+#define WEB_APP_ETAG "\"756692df4709\""
+
+static const uint8_t web_app_gz[WEB_APP_GZ_LEN] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x8d, 0x57, 0x6b, 0x6f, 0xdb, 0x36,
+    0x14, 0xfd, 0x9e, 0x5f, 0x71, 0xe7, 0xa2, 0x90, 0xd4, 0xda, 0x72, 0xd2, 0xae, 0x45, 0x60, 0x27,
+    0x1e, 0xba, 0x22, 0xdb, 0x3a, 0xf4, 0x85, 0x25, 0x9f, 0xd6, 0x15, 0x03, 0x2d, 0x5e, 0xdb, 0x6c,
+    0x25, 0x52, 0x25, 0x69, 0xe7, 0xd5, 0xfe, 0xf7, 0x1d, 0x52, 0x92, 0x23, 0x27, 0x59, 0xd1, 0x22,
+    0x68, 0x43, 0xf1, 0xf2, 0xf0, 0x3e, 0xce, 0x3d, 0xbc, 0x1d, 0x8f, 0xe9, 0x95, 0xf6, 0x6c, 0x17,
+    0xa2, 0x60, 0x2a, 0x4c, 0x55, 0x97, 0xec, 0x05, 0x49, 0x43, 0x95, 0xd1, 0xca, 0x1b, 0x4b, 0x92,
+    0xc9, 0x14, 0xeb, 0x5a, 0x14, 0xc2, 0x50, 0xfa, 0xfb, 0xc9, 0x19, 0x8d, 0x45, 0x5d, 0x67, 0xf9,
+    0xde, 0x78, 0x8c, 0x1f, 0x3a, 0x65, 0xbb, 0x51, 0xb0, 0xc6, 0x49, 0x43, 0x30, 0x32, 0x9e, 0x49,
+    0x55, 0x6b, 0x2f, 0x36, 0x5c, 0x12, 0x57, 0xd1, 0x78, 0x7c, 0xb4, 0x61, 0xeb, 0x84, 0x99, 0xe5,
+    0x9f, 0xdc, 0x84, 0x0c, 0x69, 0x53, 0x31, 0x55, 0x6b, 0x29, 0x48, 0x50, 0x21, 0xa4, 0x08, 0x38,
+    0xa2, 0x84, 0x0f, 0xf1, 0x0e, 0xc9, 0x0e, 0x18, 0xc2, 0x7e, 0x59, 0xab, 0x8d, 0x19, 0x12, 0x6b,
+    0x8f, 0x8f, 0x38, 0x04, 0xc4, 0xa5, 0x90, 0x70, 0x68, 0xb9, 0x16, 0x16, 0x67, 0xb7, 0xd7, 0xe1,
+    0x96, 0x42, 0x14, 0x2b, 0x26, 0xc7, 0x55, 0x80, 0xb2, 0xbc, 0x11, 0xa5, 0x92, 0xc2, 0x12, 0x0f,
+    0x81, 0x56, 0x1b, 0xe5, 0x42, 0x3c, 0xb5, 0x55, 0x15, 0x2b, 0x6b, 0x08, 0x81, 0x3a, 0x07, 0x64,
+    0x67, 0xc8, 0x5b, 0xb1, 0x00, 0x6a, 0x45, 0x06, 0x26, 0x00, 0x77, 0x94, 0xc2, 0x61, 0x35, 0x5e,
+    0x94, 0xc6, 0x58, 0x37, 0x0c, 0x68, 0x63, 0xde, 0xc0, 0x05, 0x47, 0x4c, 0x71, 0x67, 0x2e, 0x7c,
+    0xb1, 0xca, 0x72, 0x3a, 0x71, 0x5e, 0x95, 0x06, 0x5f, 0x2b, 0x61, 0x8b, 0xe8, 0xf7, 0x42, 0x15,
+    0x00, 0x12, 0x70, 0x1b, 0x8e, 0x59, 0x41, 0x5f, 0xd6, 0x88, 0x02, 0xbf, 0x2e, 0x95, 0x8e, 0x8b,
+    0x00, 0x56, 0x08, 0x6b, 0x71, 0xdf, 0x8d, 0xef, 0xe9, 0x12, 0x51, 0x23, 0x18, 0x1d, 0xce, 0xdb,
+    0xea, 0x5c, 0x58, 0xce, 0x48, 0xaf, 0x75, 0x21, 0x42, 0x82, 0x38, 0xdf, 0x4b, 0x17, 0x58, 0x78,
+    0x65, 0x34, 0xa5, 0x19, 0x5d, 0xef, 0x11, 0x6d, 0x10, 0x57, 0xe1, 0x1c, 0x1d, 0xd3, 0x07, 0xac,
+    0x88, 0x92, 0xb9, 0x91, 0x97, 0x74, 0x4d, 0x0b, 0xa3, 0xfd, 0x68, 0x21, 0x2a, 0x55, 0x5e, 0x4e,
+    0xc8, 0x09, 0xed, 0x46, 0x8e, 0xad, 0x5a, 0x4c, 0x83, 0x83, 0x70, 0x61, 0x42, 0xfb, 0x24, 0xd6,
+    0xde, 0x84, 0xf5, 0xc5, 0xe8, 0x5c, 0x49, 0xbf, 0x9a, 0xd0, 0xd3, 0x27, 0x5c, 0x4d, 0xe1, 0x8a,
+    0x94, 0x4a, 0x2f, 0x27, 0x74, 0x10, 0x56, 0xdf, 0x92, 0x61, 0x83, 0xbb, 0x3a, 0xe8, 0x50, 0x9d,
+    0xba, 0x62, 0xec, 0xe6, 0x4f, 0x77, 0xf6, 0x73, 0xa1, 0x43, 0x8e, 0xaf, 0x49, 0x2a, 0x57, 0x97,
+    0x02, 0xb7, 0x2e, 0x4a, 0xbe, 0x98, 0xa2, 0x92, 0x6a, 0xa9, 0x47, 0xca, 0x73, 0x85, 0x62, 0x17,
+    0x1c, 0xb8, 0x35, 0xa5, 0xa5, 0xa8, 0x27, 0x94, 0x3f, 0xdb, 0xb9, 0xae, 0x59, 0xce, 0x8d, 0x95,
+    0x6c, 0x47, 0x73, 0xe3, 0xbd, 0xa9, 0x70, 0x4b, 0x7d, 0x81, 0xc2, 0xa0, 0x7c, 0xf4, 0xa0, 0x28,
+    0x8a, 0x3b, 0xd7, 0xe5, 0x0e, 0xb4, 0xba, 0xa6, 0xb9, 0x28, 0x3e, 0x2f, 0xad, 0x59, 0x6b, 0x39,
+    0xa1, 0x07, 0xcc, 0x8b, 0xe7, 0x8b, 0x45, 0xdf, 0x34, 0x12, 0xec, 0x3a, 0xfa, 0x03, 0xc4, 0xfe,
+    0xce, 0x17, 0x2f, 0xb1, 0x51, 0x29, 0xbd, 0x4d, 0x41, 0xf0, 0xc1, 0xf3, 0x85, 0x1f, 0x45, 0xbf,
+    0x27, 0x64, 0xd5, 0x72, 0xe5, 0xa7, 0x4d, 0xe0, 0xe7, 0x1c, 0x16, 0x13, 0xf8, 0x58, 0xca, 0x3e,
+    0xca, 0x1c, 0x65, 0x14, 0xc0, 0x59, 0xb5, 0xfb, 0xcf, 0x6b, 0xc4, 0xbd, 0xe3, 0x93, 0x94, 0x72,
+    0x1b, 0x1a, 0x0a, 0xac, 0xd6, 0xc8, 0xc5, 0xd3, 0x60, 0x65, 0xd0, 0x0a, 0x60, 0xd7, 0xf9, 0x84,
+    0x56, 0x4a, 0x4a, 0xd6, 0x77, 0x61, 0xa5, 0xda, 0xf4, 0xa0, 0x0f, 0xf6, 0xf7, 0x1f, 0xde, 0xc2,
+    0x7e, 0x22, 0x0e, 0x7b, 0xa7, 0xe6, 0x6b, 0x24, 0x4e, 0xdf, 0x2e, 0x55, 0x2c, 0x65, 0x2f, 0xcc,
+    0x27, 0xf9, 0xcf, 0xbb, 0xb9, 0xdf, 0xad, 0xe5, 0x03, 0xe7, 0x85, 0x5f, 0x3b, 0xa0, 0x14, 0xa6,
+    0x34, 0x16, 0x97, 0x1c, 0x1e, 0x1e, 0x4e, 0xfb, 0x90, 0xf9, 0x61, 0xac, 0x56, 0x43, 0xa6, 0x91,
+    0x37, 0xf5, 0x96, 0x2e, 0x40, 0xf8, 0x98, 0x7f, 0x32, 0x4a, 0xa7, 0xc9, 0x3f, 0x3a, 0xc9, 0xa6,
+    0x2d, 0x47, 0x9d, 0xbf, 0x2c, 0x19, 0x2c, 0x95, 0x10, 0x8f, 0x0a, 0x2c, 0xc8, 0x0b, 0xcb, 0xc2,
+    0xf3, 0x49, 0xc9, 0x61, 0x95, 0x26, 0x71, 0xbf, 0x31, 0x8f, 0xbf, 0xe6, 0xa1, 0x08, 0x2f, 0x71,
+    0x21, 0x76, 0x71, 0x0c, 0x14, 0x0f, 0x5b, 0xdb, 0xd3, 0x2b, 0x16, 0x32, 0x87, 0x96, 0xb0, 0x96,
+    0x2f, 0x57, 0xaa, 0x94, 0x69, 0x3c, 0x94, 0xed, 0xd8, 0x84, 0x4e, 0xc8, 0x95, 0xd6, 0x6c, 0xff,
+    0x38, 0x7b, 0xf3, 0x9a, 0x8e, 0x9b, 0xd8, 0x8e, 0x56, 0x07, 0xb3, 0x37, 0x37, 0x5a, 0xf6, 0xae,
+    0xd3, 0x32, 0x48, 0xc2, 0x7b, 0xcb, 0x52, 0x99, 0xa3, 0x31, 0x2c, 0x12, 0x7a, 0xdc, 0x9a, 0x87,
+    0xfc, 0x2b, 0x79, 0x3c, 0x88, 0x7c, 0x63, 0x37, 0x98, 0x1d, 0x8d, 0xf1, 0xa9, 0x67, 0x50, 0xcf,
+    0x8e, 0xda, 0xa4, 0x07, 0xb3, 0x2b, 0x34, 0xb0, 0x1d, 0xcc, 0xfe, 0x0e, 0xff, 0x90, 0x37, 0xd0,
+    0x90, 0xa3, 0x71, 0xb3, 0x8d, 0x83, 0xf5, 0x3d, 0xb8, 0x4d, 0xaa, 0x07, 0x33, 0xc4, 0xca, 0x85,
+    0xc7, 0x2d, 0x26, 0xcf, 0xf3, 0xf6, 0x8e, 0xe9, 0x5e, 0x9b, 0xbd, 0x46, 0x80, 0x42, 0x93, 0x7f,
+    0x1c, 0x42, 0x35, 0xe0, 0xb1, 0xf2, 0x97, 0xed, 0x52, 0x8b, 0x8a, 0xbb, 0x2d, 0xb4, 0x03, 0x40,
+    0x58, 0x62, 0xb9, 0xdf, 0x65, 0xbe, 0x54, 0xb8, 0xa2, 0x9f, 0xf9, 0x25, 0xfb, 0x36, 0xed, 0xbf,
+    0x5e, 0xbe, 0x92, 0x69, 0xd2, 0x46, 0x96, 0x64, 0x38, 0xdf, 0xd4, 0xfd, 0x3b, 0xc6, 0x8d, 0x45,
+    0x28, 0x14, 0xe0, 0xb7, 0x62, 0x14, 0x3a, 0x2c, 0x55, 0x50, 0x24, 0xa8, 0xad, 0x5f, 0x5b, 0xdd,
+    0x38, 0xf5, 0x41, 0x7d, 0xa4, 0xaf, 0x5f, 0x29, 0x55, 0x74, 0x7c, 0x0c, 0x87, 0xe8, 0x17, 0x4a,
+    0xce, 0x18, 0x8a, 0x67, 0x12, 0x9a, 0x50, 0xf2, 0x22, 0xea, 0x05, 0x12, 0x42, 0x2a, 0x03, 0x71,
+    0x76, 0xf0, 0x2c, 0xea, 0xca, 0xb6, 0x95, 0x38, 0x6a, 0x42, 0xe8, 0x97, 0x92, 0x92, 0x64, 0x1a,
+    0x77, 0x9a, 0xc4, 0xe4, 0x0b, 0x63, 0x4f, 0xa0, 0xf9, 0x3d, 0x75, 0xd4, 0x43, 0x52, 0xdd, 0xf1,
+    0x26, 0x0f, 0xd6, 0x9c, 0x7f, 0x87, 0x7f, 0xc8, 0x77, 0xc3, 0xbe, 0xf0, 0x07, 0xa6, 0x79, 0x51,
+    0x0a, 0xe7, 0xde, 0x22, 0x8c, 0x70, 0x5b, 0x4c, 0x51, 0x70, 0xb5, 0x8d, 0x65, 0x9b, 0x67, 0x84,
+    0x14, 0x16, 0x31, 0xa0, 0xdd, 0xf3, 0x3b, 0xde, 0x1e, 0xb9, 0x5a, 0x68, 0x8a, 0x90, 0xc7, 0x83,
+    0x90, 0xac, 0x41, 0x60, 0xc2, 0x36, 0x6d, 0x8f, 0x5b, 0x3e, 0xb4, 0x06, 0xb1, 0xf1, 0x41, 0xb4,
+    0xf0, 0x29, 0xf2, 0xfa, 0x78, 0xd0, 0xf4, 0x6d, 0xc7, 0x9e, 0xf0, 0xe7, 0x8d, 0xf0, 0xab, 0x1c,
+    0x2d, 0x9d, 0x42, 0x12, 0x40, 0x02, 0x7a, 0x14, 0xb4, 0x81, 0xc6, 0x94, 0x76, 0xf4, 0x68, 0xb3,
+    0xff, 0x6c, 0x3f, 0x8b, 0x17, 0x3c, 0xec, 0x98, 0xdb, 0xfd, 0x1d, 0x5c, 0x9a, 0xf5, 0x11, 0x93,
+    0x8e, 0xc7, 0x52, 0x78, 0x31, 0x32, 0xf5, 0xf1, 0xc0, 0x72, 0x05, 0x81, 0x1a, 0xcc, 0x46, 0x37,
+    0x1c, 0xee, 0x07, 0x02, 0xf5, 0x6c, 0xe3, 0x88, 0x11, 0xfc, 0x08, 0x22, 0x04, 0x67, 0x30, 0x7b,
+    0xbc, 0x85, 0x4b, 0xfa, 0x19, 0xc3, 0xa3, 0x68, 0x2f, 0x4f, 0x63, 0x66, 0x8d, 0x7d, 0x51, 0x96,
+    0x69, 0x2b, 0x66, 0x49, 0x76, 0x4f, 0x7d, 0xe7, 0x37, 0xc5, 0x25, 0x9a, 0xe7, 0x46, 0x17, 0xa5,
+    0x2a, 0x3e, 0x23, 0xd7, 0x3b, 0x0f, 0x24, 0x6a, 0xa3, 0x25, 0x6a, 0x06, 0xf7, 0x86, 0xc1, 0xd1,
+    0x79, 0x1e, 0x3c, 0x71, 0xec, 0x73, 0x53, 0x07, 0xd2, 0x75, 0xd7, 0x7f, 0xdb, 0x96, 0xae, 0xa1,
+    0x5a, 0x5f, 0x59, 0xe0, 0x5a, 0xbb, 0xdb, 0x58, 0xed, 0x32, 0x15, 0x96, 0xe5, 0x65, 0x1a, 0xba,
+    0x82, 0x3b, 0x8f, 0xb6, 0xcd, 0x1a, 0xbf, 0xe6, 0xcd, 0xb2, 0x41, 0x88, 0x6f, 0x7e, 0x28, 0x0f,
+    0xa6, 0x0b, 0x4c, 0x2a, 0x91, 0x00, 0x8e, 0x36, 0x18, 0x59, 0x9a, 0xd9, 0xa8, 0x1b, 0x35, 0xe2,
+    0x16, 0x39, 0x2d, 0x6a, 0xb7, 0x32, 0x78, 0x7e, 0x0c, 0x95, 0x61, 0x3c, 0x68, 0x46, 0x94, 0x2b,
+    0x12, 0x0e, 0xc2, 0x8c, 0x41, 0x68, 0xc9, 0xda, 0x45, 0x5c, 0xb5, 0xa0, 0xc6, 0x87, 0xbc, 0xab,
+    0x7e, 0xd6, 0x97, 0x89, 0xdd, 0xad, 0xe9, 0xad, 0x23, 0xb1, 0x57, 0xb3, 0xad, 0x8e, 0xf4, 0x3e,
+    0xde, 0xb6, 0xdc, 0xd2, 0xfe, 0x27, 0xf4, 0x00, 0x5e, 0x1f, 0x5e, 0x28, 0xcd, 0x32, 0xeb, 0xcb,
+    0xce, 0xae, 0x61, 0x03, 0xd0, 0x75, 0xf3, 0xdd, 0xec, 0xc5, 0xf2, 0x98, 0xda, 0x6d, 0x53, 0xc7,
+    0x18, 0xa7, 0xd2, 0xe4, 0x66, 0xb4, 0x4a, 0x86, 0xe1, 0x7d, 0x66, 0xbf, 0x32, 0x78, 0xea, 0x92,
+    0xf7, 0xef, 0x4e, 0xcf, 0xf0, 0x25, 0x08, 0x3b, 0x06, 0xc7, 0xda, 0xa1, 0x22, 0x6d, 0xd9, 0x72,
+    0xbf, 0x62, 0xdd, 0xa3, 0x87, 0xed, 0x69, 0x91, 0xc5, 0x9c, 0x69, 0x74, 0x1a, 0xea, 0xbd, 0x6b,
+    0x1e, 0x6b, 0xb7, 0xfd, 0x54, 0x84, 0xfb, 0xd2, 0x5b, 0xf4, 0x89, 0x6a, 0x77, 0xeb, 0x2d, 0x4a,
+    0x7e, 0x13, 0xe5, 0x0a, 0xc3, 0x2a, 0xc6, 0x3d, 0xbd, 0x51, 0xd0, 0x85, 0x69, 0x9f, 0x19, 0xff,
+    0xab, 0x9c, 0xf1, 0x65, 0x00, 0x97, 0xbf, 0x4b, 0xd5, 0xe4, 0xd1, 0xb0, 0x28, 0x59, 0xd8, 0x7f,
+    0x45, 0x59, 0x26, 0x0d, 0x43, 0xf7, 0x76, 0xd3, 0xd2, 0x10, 0x04, 0x38, 0x3f, 0x18, 0x71, 0x3f,
+    0xd4, 0xed, 0x7b, 0x12, 0x0b, 0xad, 0xf9, 0x9c, 0x4e, 0xc2, 0x34, 0x7b, 0x6a, 0xd6, 0xb6, 0x60,
+    0xe0, 0x37, 0xb3, 0x6d, 0xa3, 0x63, 0xec, 0x72, 0x34, 0x6b, 0xdc, 0x7f, 0x8d, 0x9e, 0x60, 0xa8,
+    0x19, 0xd4, 0xbf, 0x65, 0x24, 0x8a, 0x70, 0x73, 0x73, 0x20, 0x7e, 0xdb, 0x07, 0x7f, 0x9e, 0xbe,
+    0x7b, 0x9b, 0x63, 0xdc, 0x75, 0x9c, 0x72, 0x6c, 0xb5, 0x2c, 0xeb, 0x92, 0x73, 0x2f, 0x5e, 0x0c,
+    0xe6, 0x0e, 0xd8, 0x5e, 0x27, 0xd9, 0x81, 0x50, 0x77, 0x21, 0xfb, 0xca, 0xff, 0x41, 0x36, 0xfd,
+    0xf5, 0x31, 0x48, 0x7b, 0x5e, 0x60, 0x24, 0xf2, 0xf7, 0x70, 0xae, 0x73, 0xc0, 0x68, 0x83, 0xbe,
+    0xbe, 0x9b, 0xf9, 0x7b, 0xab, 0xfc, 0xc2, 0xaf, 0x31, 0x03, 0x5e, 0xc5, 0xe1, 0x00, 0x3f, 0x1b,
+    0xfc, 0xf7, 0x23, 0x69, 0x25, 0x23, 0x42, 0xe1, 0x25, 0xc3, 0x08, 0xf1, 0x63, 0x58, 0x7f, 0x71,
+    0xd1, 0x7f, 0xde, 0x1b, 0x9c, 0x6f, 0x59, 0x70, 0xef, 0x3f, 0xb3, 0xf9, 0x0c, 0xde, 0x71, 0x0d,
+    0x00, 0x00
+};
@@ -0,0 +1,107 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Limites das regras (RAM fixa, ~1,5 KB com os valores abaixo)
+#define ALERTS_MAX_RULES   64            // regras depois de expandir "*"
+#define ALERTS_MAX_FLOORS  32
+#define ALERTS_WORDS       ((ALERTS_MAX_RULES + 31) / 32)
+
+typedef enum {
+    ALERT_ABOVE = 0,                     // ocupação > limite
+    ALERT_BELOW,                         // ocupação < limite
+} alert_kind_t;
+
+typedef enum {
+    ALERT_IDLE = 0,
+    ALERT_PENDING,                       // condição verdadeira, esperando hold_s
+    ALERT_ACTIVE,
+} alert_state_t;
+
+// Regra de um andar. Dispara quando a condição vale por hold_s segundos
+// seguidos e só volta ao normal depois de passar hysteresis pessoas do limite
+// no sentido contrário (acima: ocupação <= limite - histerese; abaixo:
+// ocupação >= limite + histerese), para não oscilar em torno do limite.
+typedef struct {
+    uint8_t floor;
+    uint8_t kind;                        // alert_kind_t
+    uint8_t state;                       // alert_state_t
+    uint16_t limit;
+    uint16_t hysteresis;
+    uint32_t hold_s;                     // 0 = dispara na alteração
+    uint32_t since_s;                    // início da condição (PENDING) ou do alerta (ACTIVE)
+} alert_rule_t;
+
+// Regras carregadas no boot. Cada andar guarda a máscara das suas regras, e só
+// elas são avaliadas quando a ocupação do andar muda; regras pendentes vencem
+// por prazo (next_due_s), sem varrer as demais.
+typedef struct {
+    uint8_t num_rules;
+    uint8_t num_active;
+    alert_rule_t rules[ALERTS_MAX_RULES];
+    uint32_t floor_rules[ALERTS_MAX_FLOORS][ALERTS_WORDS];
+    uint32_t active[ALERTS_WORDS];       // regras em ALERT_ACTIVE
+    uint32_t pending[ALERTS_WORDS];      // regras em ALERT_PENDING
+    uint32_t reported[ALERTS_WORDS];     // último estado entregue por alerts_next_change
+    uint32_t changed[ALERTS_WORDS];      // regras que mudaram desde a última entrega
+    uint32_t next_due_s;                 // menor prazo entre as pendentes (UINT32_MAX se nenhuma)
+} alerts_t;
+
+/**
+ * @brief Carrega as regras a partir de um texto, uma por linha:
+ *          above <andar|*> <limite> [<histerese> [<segundos>]]
+ *          below <andar|*> <limite> [<histerese> [<segundos>]]
+ *        O andar é o índice global (como em ?floor=); "*" cria uma regra por
+ *        andar. Linhas vazias e começadas por '#' são ignoradas. Todas as
+ *        regras começam em ALERT_IDLE (ver alerts_update).
+ * @param a Regras a preencher.
+ * @param text Texto terminado em '\0'.
+ * @param num_floors Andares existentes.
+ * @param error_line Recebe a linha com erro (0 se o erro não for de uma linha).
+ * @return false se o texto for inválido ou não couber em ALERTS_MAX_RULES;
+ *         nesse caso nenhuma regra fica carregada.
+ */
+bool alerts_load(alerts_t *a, const char *text, uint8_t num_floors, unsigned *error_line);
+
+/**
+ * @brief Reavalia as regras de um andar após uma alteração da ocupação.
+ *        Custa O(regras do andar).
+ * @param floor Índice do andar.
+ * @param count Nova ocupação do andar.
+ * @param now_s Instante da alteração (segundos desde o boot).
+ */
+void alerts_update(alerts_t *a, uint8_t floor, uint32_t count, uint32_t now_s);
+
+/**
+ * @brief Dispara as regras pendentes cujo prazo venceu.
+ * @return true se alguma regra mudou de estado.
+ */
+bool alerts_poll(alerts_t *a, uint32_t now_s);
+
+/**
+ * @brief Há regra pendente com prazo vencido (ver alerts_poll)?
+ */
+static inline bool alerts_due(const alerts_t *a, uint32_t now_s) {
+    return now_s >= a->next_due_s;
+}
+
+/**
+ * @brief Retira a próxima regra que entrou ou saiu de ALERT_ACTIVE desde a
+ *        última chamada. Uma regra que disparou e voltou ao normal entre duas
+ *        chamadas não é entregue.
+ * @param active Recebe o novo estado.
+ * @return Índice da regra, ou -1 se nenhuma mudou.
+ */
+int alerts_next_change(alerts_t *a, bool *active);
+
+/**
+ * @brief Primeira regra ativa de um andar numa máscara de regras ativas
+ *        (a->active ou uma cópia dela).
+ * @return Índice da regra, ou -1 se nenhuma.
+ */
+int alerts_first_active(const alerts_t *a, const uint32_t *active, uint8_t floor);
+
+#endif // ALERTS_H
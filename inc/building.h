@@ -0,0 +1,100 @@
+#ifndef BUILDING_H
+#define BUILDING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Limites do modelo (RAM fixa, ~5 KB com os valores abaixo)
+#define BUILDING_MAX_BUILDINGS    4
+#define BUILDING_MAX_FLOORS       32
+#define BUILDING_MAX_ZONES        512
+#define BUILDING_NAME_MAX         24     // caracteres por nome
+#define BUILDING_DEFAULT_CAPACITY 50     // zona implícita de um andar sem "zone"
+
+// Nome dentro do texto de configuração (que fica na flash): só posição e
+// tamanho, sem cópia. Para imprimir: "%.*s" com BUILDING_NAME_ARGS.
+typedef struct {
+    uint16_t offset;
+    uint8_t len;
+} building_name_t;
+
+#define BUILDING_NAME_ARGS(m, n)  (int)(n).len, (m)->source + (n).offset
+
+typedef struct {
+    building_name_t name;
+    uint8_t first_floor;                 // andares [first_floor, first_floor + num_floors)
+    uint8_t num_floors;
+} building_t;
+
+typedef struct {
+    building_name_t name;
+    uint8_t building;
+    uint16_t first_zone;                 // zonas [first_zone, first_zone + num_zones)
+    uint16_t num_zones;
+    uint32_t count;                      // soma das zonas, mantida a cada alteração
+    uint32_t capacity;                   // soma das capacidades
+} building_floor_t;
+
+// Modelo carregado no boot. Prédios, andares e zonas ficam em vetores planos,
+// cada nível apontando para uma faixa contígua do nível de baixo; os contadores
+// das zonas (16 bits) ficam juntos, separados dos dados que não mudam.
+typedef struct {
+    const char *source;                  // texto da configuração (deve continuar válido)
+    uint8_t num_buildings;
+    uint8_t num_floors;
+    uint16_t num_zones;
+    building_t buildings[BUILDING_MAX_BUILDINGS];
+    building_floor_t floors[BUILDING_MAX_FLOORS];
+    building_name_t zone_names[BUILDING_MAX_ZONES];
+    uint8_t zone_floor[BUILDING_MAX_ZONES];
+    uint16_t zone_capacity[BUILDING_MAX_ZONES];
+    uint16_t zone_count[BUILDING_MAX_ZONES];
+    uint32_t dirty[(BUILDING_MAX_FLOORS + 31) / 32];  // andares alterados (ver building_next_dirty)
+} building_model_t;
+
+/**
+ * @brief Carrega o modelo a partir de um texto de configuração, uma diretiva por linha:
+ *          building <nome>
+ *          floor <nome>
+ *          zone <capacidade> <nome>
+ *        Linhas vazias e começadas por '#' são ignoradas. Um andar sem "zone"
+ *        recebe uma zona com o nome do andar e BUILDING_DEFAULT_CAPACITY.
+ *        Todos os contadores começam em zero.
+ * @param m Modelo a preencher.
+ * @param text Configuração terminada em '\0'; os nomes apontam para ela.
+ * @param error_line Recebe a linha com erro (0 se o erro não for de uma linha).
+ * @return false se a configuração for inválida ou não couber nos limites.
+ */
+bool building_load(building_model_t *m, const char *text, unsigned *error_line);
+
+/**
+ * @brief Índice global de uma zona de um andar.
+ * @return Índice em zone_*, ou -1 se o andar ou a zona não existir.
+ */
+int building_zone_index(const building_model_t *m, int floor, int zone);
+
+/**
+ * @brief Define a contagem de uma zona, limitada a 0..capacidade.
+ * @param m Modelo.
+ * @param zone Índice global da zona.
+ * @param value Novo valor (pode estar fora da faixa).
+ * @return Contagem resultante.
+ */
+uint16_t building_zone_set(building_model_t *m, uint16_t zone, int32_t value);
+
+/**
+ * @brief Recalcula os totais dos andares depois que zone_count foi preenchido
+ *        diretamente (ex.: recuperado da flash). Contagens acima da capacidade
+ *        são limitadas; nenhum andar fica marcado como alterado.
+ * @param m Modelo.
+ */
+void building_recount(building_model_t *m);
+
+/**
+ * @brief Retira o próximo andar marcado como alterado.
+ * @return Índice do andar, ou -1 se nenhum mudou desde a última chamada.
+ */
+int building_next_dirty(building_model_t *m);
+
+#endif // BUILDING_H
@@ -0,0 +1,36 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flash_store.h"
+
+// Configuração do prédio enviada em tempo de execução (POST /api/config). Fica
+// em dois setores logo abaixo da região de flash_store: o texto a partir da
+// página 1 (terminado em '\0') e o cabeçalho na página 0.
+#define CONFIG_STORE_SECTORS     2
+#define CONFIG_STORE_OFFSET      (FLASH_STORE_OFFSET - CONFIG_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#define CONFIG_STORE_MAX         (FLASH_SECTOR_SIZE - FLASH_PAGE_SIZE - 1)  // bytes de texto
+
+/**
+ * @brief Configuração gravada mais recente, lida direto da flash (XIP).
+ * @return Texto terminado em '\0', válido enquanto o programa rodar (a próxima
+ *         gravação vai para o outro setor), ou NULL se não houver nenhuma ou se
+ *         a última gravada estiver vazia (volta para a configuração do build).
+ */
+const char *config_store_load(void);
+
+/**
+ * @brief Grava uma configuração no setor que não está em uso. O cabeçalho é
+ *        programado por último: uma gravação interrompida deixa a anterior
+ *        valendo. Apagar/programar a flash suspende o XIP: chamar no loop
+ *        principal, como flash_store_flush.
+ * @param text Configuração (sem '\0'); len == 0 apaga a configuração enviada.
+ * @param len Tamanho, até CONFIG_STORE_MAX.
+ * @return false se a região colide com o programa ou a gravação falhou.
+ */
+bool config_store_save(const char *text, size_t len);
+
+#endif // CONFIG_STORE_H
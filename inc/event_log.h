@@ -0,0 +1,58 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Registros guardados (potência de 2); os mais antigos são sobrescritos
+#define EVENT_LOG_CAPACITY  1024
+#define EVENT_LOG_ZONE_MAX  2047     // maior índice de zona representável
+
+// Origem de uma alteração de ocupação
+typedef enum {
+    EVENT_SOURCE_HTTP = 0,           // página (GET /?action=...)
+    EVENT_SOURCE_WS,                 // comando WebSocket
+    EVENT_SOURCE_BATCH,              // POST /api/batch
+    EVENT_SOURCE_EXPIRE,             // crachá removido por falta de leitura
+    EVENT_SOURCE_COUNT,
+} event_source_t;
+
+// Registro compacto (8 bytes): variação de uma zona em um instante
+typedef struct {
+    uint32_t time_s;                 // segundos desde o boot
+    uint32_t zone : 11;              // índice global da zona
+    uint32_t source : 3;             // event_source_t
+    int32_t delta : 18;              // variação da contagem (±65535 cabe)
+} event_record_t;
+
+// Fila circular de tamanho fixo. Cada registro tem um número de sequência
+// implícito, que só cresce: o registro seq fica em records[seq % capacidade]
+// enquanto estiver entre os EVENT_LOG_CAPACITY mais recentes.
+typedef struct {
+    event_record_t records[EVENT_LOG_CAPACITY];
+    uint32_t next_seq;               // sequência do próximo registro
+} event_log_t;
+
+/**
+ * @brief Acrescenta um registro, sobrescrevendo o mais antigo se a fila estiver cheia.
+ * @param log Fila.
+ * @param time_s Instante (segundos desde o boot).
+ * @param zone Índice global da zona (até EVENT_LOG_ZONE_MAX).
+ * @param delta Variação da contagem.
+ * @param source Origem da alteração.
+ */
+void event_log_append(event_log_t *log, uint32_t time_s, uint16_t zone, int32_t delta, event_source_t source);
+
+/**
+ * @brief Sequência do registro mais antigo ainda guardado (== next_seq se vazia).
+ */
+uint32_t event_log_oldest(const event_log_t *log);
+
+/**
+ * @brief Registro de uma sequência.
+ * @return NULL se o registro já foi sobrescrito ou ainda não existe.
+ */
+const event_record_t *event_log_get(const event_log_t *log, uint32_t seq);
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,72 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hardware/flash.h"
+
+// Região reservada no fim da flash (setores de 4 KB usados em rodízio)
+#define FLASH_STORE_SECTORS      8
+#define FLASH_STORE_SIZE         (FLASH_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#define FLASH_STORE_OFFSET       (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE)
+#define FLASH_STORE_MAX_VALUES   1024    // contadores por snapshot (metade do setor)
+#define FLASH_STORE_PENDING_MAX  64      // alterações acumuladas entre gravações
+
+// Estado em RAM do armazenamento. O setor ativo tem, nesta ordem: cabeçalho
+// (página 0), snapshot de todos os contadores e o log de alterações, um
+// registro de 4 bytes (índice + valor novo) por alteração. As alterações
+// ficam em pending até flash_store_flush; o log cheio (ou pending cheio)
+// vira um snapshot novo no próximo setor.
+typedef struct {
+    bool enabled;                        // false se a região colide com o programa
+    uint16_t *values;                    // contadores (memória do chamador)
+    uint16_t num_values;
+    uint32_t config_hash;                // identifica o significado dos índices
+    uint8_t sector;                      // setor ativo
+    uint32_t seq;                        // número de sequência do setor ativo
+    uint16_t log_page;                   // página do log em preenchimento
+    uint16_t page_used;                  // registros já gravados nessa página
+    uint32_t page[FLASH_PAGE_SIZE / 4];  // imagem da página em preenchimento
+    uint32_t pending[FLASH_STORE_PENDING_MAX];
+    uint16_t num_pending;
+    bool compact_needed;                 // próximo flush grava um snapshot novo
+    uint32_t compactions;                // snapshots gravados desde o boot
+    uint32_t replayed;                   // registros do log aplicados no boot
+} flash_store_t;
+
+/**
+ * @brief Hash FNV-1a, para derivar config_hash da configuração.
+ */
+uint32_t flash_store_hash(const void *data, size_t len);
+
+/**
+ * @brief Abre a região e recupera os contadores: o snapshot mais recente
+ *        válido mais o log gravado depois dele. Só lê a flash (via XIP).
+ * @param s Estado a preencher.
+ * @param values Contadores; recebem os valores recuperados (ou zero).
+ * @param num_values Quantidade de contadores (até FLASH_STORE_MAX_VALUES).
+ * @param config_hash Snapshots gravados com outro hash ou outra quantidade
+ *                    de contadores são ignorados.
+ * @return true se havia estado salvo; false se os contadores foram zerados.
+ */
+bool flash_store_init(flash_store_t *s, uint16_t *values, uint16_t num_values, uint32_t config_hash);
+
+/**
+ * @brief Registra o valor novo de um contador (só RAM, não toca a flash).
+ * @param s Estado.
+ * @param index Índice do contador.
+ * @param value Valor já gravado em values[index].
+ */
+void flash_store_record(flash_store_t *s, uint16_t index, uint16_t value);
+
+/**
+ * @brief Grava na flash as alterações pendentes e, se preciso, compacta.
+ *        Apagar/programar a flash suspende o XIP: chamar fora dos caminhos
+ *        críticos (no loop principal).
+ * @return false se alguma operação na flash falhou.
+ */
+bool flash_store_flush(flash_store_t *s);
+
+#endif // FLASH_STORE_H
@@ -0,0 +1,106 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Limites do parser (tudo em memória fixa, dentro do estado da conexão)
+#define HTTP_METHOD_MAX        8     // "GET", "POST", ...
+#define HTTP_PATH_MAX          32
+#define HTTP_MAX_PARAMS        8     // pares chave=valor na query string (mais: 400)
+#define HTTP_PARAM_KEY_MAX     8
+#define HTTP_PARAM_VALUE_MAX   16
+#define HTTP_HEADER_NAME_MAX   24
+#define HTTP_HEADER_VALUE_MAX  64
+#define HTTP_ETAG_MAX          64    // If-None-Match (lista de ETags, truncada)
+#define HTTP_WS_KEY_MAX        32    // Sec-WebSocket-Key (24 caracteres base64)
+#define HTTP_HOST_MAX          24    // Host (truncado; basta para comparar com o IP local)
+#define HTTP_HEADERS_MAX       4096  // bytes máximos de linha + cabeçalhos
+
+typedef enum {
+    HTTP_METHOD_UNKNOWN = 0,
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+} http_method_t;
+
+typedef enum {
+    HTTP_PARSE_INCOMPLETE = 0,   // precisa de mais bytes
+    HTTP_PARSE_COMPLETE,         // linha de requisição e cabeçalhos lidos
+    HTTP_PARSE_ERROR,            // requisição inválida (ver status)
+} http_parse_result_t;
+
+// Cabeçalhos que o servidor usa; os demais são descartados sem cópia
+typedef enum {
+    HTTP_HEADER_NONE = 0,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADER_UPGRADE,
+    HTTP_HEADER_WEBSOCKET_KEY,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_ACCEPT_ENCODING,
+    HTTP_HEADER_HOST,
+} http_header_id_t;
+
+typedef struct {
+    char key[HTTP_PARAM_KEY_MAX];
+    char value[HTTP_PARAM_VALUE_MAX];
+} http_param_t;
+
+// Estado do parser incremental. Mantido por conexão entre callbacks, de modo
+// que uma requisição pode chegar dividida em qualquer ponto.
+typedef struct {
+    uint8_t state;
+    uint8_t tok_len;                     // bytes no token atual
+    uint8_t header;                      // http_header_id_t sendo lido
+    uint16_t header_bytes;               // bytes consumidos nesta requisição
+    char tok[HTTP_HEADER_NAME_MAX];      // método, versão ou nome de cabeçalho
+    char hvalue[HTTP_HEADER_VALUE_MAX];  // valor do cabeçalho de interesse
+
+    // Resultado
+    http_method_t method;
+    uint8_t http_minor;                  // HTTP/1.x
+    bool keep_alive;
+    uint16_t status;                     // código HTTP em caso de erro
+    char path[HTTP_PATH_MAX];
+    uint8_t path_len;
+    uint8_t route;                       // rota resolvida pelo servidor (0 = ainda não)
+    http_param_t params[HTTP_MAX_PARAMS];
+    uint8_t num_params;
+    char if_none_match[HTTP_ETAG_MAX];   // "" se ausente
+    bool connection_upgrade;             // "Connection: Upgrade"
+    bool upgrade_websocket;              // "Upgrade: websocket"
+    char websocket_key[HTTP_WS_KEY_MAX]; // "" se ausente
+    bool has_content_length;
+    uint32_t content_length;             // tamanho do corpo (o parser não o lê)
+    bool accept_gzip;                    // "Accept-Encoding" inclui gzip
+    char host[HTTP_HOST_MAX];            // "" se ausente
+} http_parser_t;
+
+/**
+ * @brief Prepara o parser para uma nova requisição.
+ * @param p Estado do parser.
+ */
+void http_parser_reset(http_parser_t *p);
+
+/**
+ * @brief Consome bytes de uma requisição, parando no fim dos cabeçalhos.
+ * @param p Estado do parser.
+ * @param data Bytes recebidos (não precisam terminar em '\0').
+ * @param len Quantidade de bytes disponíveis.
+ * @param consumed Recebe quantos bytes foram consumidos; o restante pertence
+ *                 à próxima requisição (pipelining).
+ * @return HTTP_PARSE_COMPLETE, HTTP_PARSE_INCOMPLETE ou HTTP_PARSE_ERROR.
+ */
+http_parse_result_t http_parser_feed(http_parser_t *p, const char *data, size_t len, size_t *consumed);
+
+/**
+ * @brief Compara o If-None-Match recebido com o ETag atual (comparação fraca):
+ *        aceita "*", listas separadas por vírgula e o prefixo W/.
+ * @param header Valor de If-None-Match ("" se ausente).
+ * @param etag ETag atual, com as aspas.
+ * @return true se o cliente já tem essa versão (responder 304).
+ */
+bool http_etag_match(const char *header, const char *etag);
+
+#endif // HTTP_PARSER_H
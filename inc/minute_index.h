@@ -0,0 +1,72 @@
+#ifndef MINUTE_INDEX_H
+#define MINUTE_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Minutos guardados por andar (no máximo o último dia) e andares indexados.
+// Cada minuto custa 8 bytes (somas de 32 bits + árvore de máximos de 16 bits);
+// o espaço do índice é um bloco fixo (~56 KB, um dia inteiro para 5 andares)
+// dividido entre os andares do prédio carregado, então com mais andares cada
+// um guarda menos minutos (32 andares: 225 minutos).
+#define MINUTE_INDEX_SLOTS       1440
+#define MINUTE_INDEX_POOL_SLOTS  (5 * MINUTE_INDEX_SLOTS)
+#define MINUTE_INDEX_MAX_FLOORS  32
+
+// Índice de um andar. O minuto p fica no slot p % slots das duas árvores, que
+// apontam para a parte do andar no bloco comum: uma Fenwick com pessoas×segundo
+// de cada minuto (somas de faixas) e uma árvore de segmentos com o pico de cada
+// minuto (máximo de faixas), ambas atualizadas em O(log n) por minuto alterado.
+typedef struct {
+    uint32_t *sum;                           // Fenwick (slot i no nó i + 1, base 1)
+    uint16_t *peak;                          // folhas em [slots, 2*slots), raiz em 1
+    uint16_t slots;                          // minutos guardados
+    uint16_t count;                          // ocupação atual (saturada em 65535)
+    uint32_t last_s;                         // instante até onde a integral foi somada
+} minute_index_floor_t;
+
+typedef struct {
+    uint32_t start_s;                        // início do índice (minutos anteriores não existem)
+    uint8_t num_floors;
+    minute_index_floor_t floors[MINUTE_INDEX_MAX_FLOORS];
+    uint32_t sum_pool[MINUTE_INDEX_POOL_SLOTS];
+    uint16_t peak_pool[2 * MINUTE_INDEX_POOL_SLOTS];
+} minute_index_t;
+
+// Resultado de uma consulta de faixa
+typedef struct {
+    uint32_t first_min;                      // primeiro minuto (desde o boot) coberto
+    uint32_t last_min;                       // último minuto coberto
+    uint32_t seconds;                        // duração coberta (menor no início do índice e no minuto atual)
+    uint32_t person_s;                       // integral em pessoas×segundo (módulo 2^32)
+    uint16_t peak;                           // maior ocupação na faixa
+} minute_index_range_t;
+
+/**
+ * @brief Começa o índice com a ocupação atual de cada andar e divide o bloco
+ *        de minutos entre os andares (até MINUTE_INDEX_SLOTS por andar).
+ * @param num_floors Andares do prédio; só os MINUTE_INDEX_MAX_FLOORS primeiros são indexados.
+ * @param now_s Instante atual (segundos desde o boot).
+ * @param counts Ocupação inicial de cada andar.
+ */
+void minute_index_init(minute_index_t *mi, uint8_t num_floors, uint32_t now_s, const uint16_t *counts);
+
+/**
+ * @brief Registra a nova ocupação de um andar: O(log n) no minuto atual, mais
+ *        O(log n) por minuto sem alterações desde a última chamada (limitado a
+ *        uma reconstrução O(n) depois de uma janela inteira parada). Andares fora do
+ *        índice são ignorados.
+ * @param now_s Instante da alteração (não decrescente).
+ */
+void minute_index_set(minute_index_t *mi, uint8_t floor, uint32_t now_s, uint32_t count);
+
+/**
+ * @brief Soma e pico da ocupação nos minutos guardados que cruzam
+ *        [from_s, to_s], em O(log n). Fecha antes a integral até now_s.
+ * @return false se o andar não é indexado ou nenhum minuto guardado cruza a faixa.
+ */
+bool minute_index_query(minute_index_t *mi, uint8_t floor, uint32_t from_s, uint32_t to_s, uint32_t now_s,
+                        minute_index_range_t *range);
+
+#endif // MINUTE_INDEX_H
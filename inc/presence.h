@@ -0,0 +1,87 @@
+#ifndef PRESENCE_H
+#define PRESENCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Tabela de presença (8 bytes por slot, 32 KB com os valores abaixo)
+#define PRESENCE_CAPACITY      4096      // slots (potência de 2)
+#define PRESENCE_MAX_ENTRIES   (PRESENCE_CAPACITY * 3 / 4)  // ocupação máxima da tabela
+#define PRESENCE_EMPTY_ID      0         // ID reservado: slot livre
+
+// Crachá presente: zona atual e último registro (minutos desde o boot,
+// comparados em aritmética modular de 16 bits)
+typedef struct {
+    uint32_t id;
+    uint16_t zone;
+    uint16_t seen_min;
+} presence_entry_t;
+
+typedef enum {
+    PRESENCE_ENTERED = 0,        // crachá novo
+    PRESENCE_MOVED,              // estava em outra zona (ver old_zone)
+    PRESENCE_REFRESHED,          // já estava na mesma zona: só renova o instante
+    PRESENCE_LEFT,               // saída registrada (ver old_zone)
+    PRESENCE_NOT_FOUND,          // saída de crachá que não estava presente
+    PRESENCE_FULL,               // tabela cheia
+} presence_result_t;
+
+// Hash com endereçamento aberto (sondagem linear). A remoção desloca para
+// trás os registros seguintes do mesmo agrupamento, então não há marcadores
+// de slot apagado e as buscas continuam curtas com a tabela em uso contínuo.
+typedef struct {
+    presence_entry_t slots[PRESENCE_CAPACITY];
+    uint16_t count;                      // crachás presentes
+    uint16_t ttl_min;                    // validade de um registro sem nova leitura
+    uint16_t sweep;                      // próximo slot verificado por presence_expire
+} presence_table_t;
+
+/**
+ * @brief Esvazia a tabela.
+ * @param ttl_min Minutos sem nova leitura até o crachá ser considerado fora.
+ */
+void presence_init(presence_table_t *p, uint16_t ttl_min);
+
+/**
+ * @brief Registra a entrada (ou troca de zona) de um crachá.
+ * @param id ID do crachá (diferente de PRESENCE_EMPTY_ID).
+ * @param zone Zona onde o crachá foi lido.
+ * @param now_min Instante atual, em minutos.
+ * @param old_zone Recebe a zona anterior quando o resultado é PRESENCE_MOVED.
+ * @return PRESENCE_ENTERED, PRESENCE_MOVED, PRESENCE_REFRESHED ou PRESENCE_FULL.
+ */
+presence_result_t presence_checkin(presence_table_t *p, uint32_t id, uint16_t zone, uint16_t now_min,
+                                   uint16_t *old_zone);
+
+/**
+ * @brief Registra a saída de um crachá.
+ * @param old_zone Recebe a zona em que ele estava.
+ * @return PRESENCE_LEFT ou PRESENCE_NOT_FOUND.
+ */
+presence_result_t presence_checkout(presence_table_t *p, uint32_t id, uint16_t *old_zone);
+
+/**
+ * @brief Zona atual de um crachá.
+ * @return false se o crachá não está presente.
+ */
+bool presence_lookup(const presence_table_t *p, uint32_t id, uint16_t *zone);
+
+/**
+ * @brief Procura registros vencidos, continuando de onde a última chamada parou.
+ *        Remove no máximo um por chamada; o chamador desconta a zona e repete.
+ * @param now_min Instante atual, em minutos.
+ * @param budget Slots a verificar nesta chamada.
+ * @param expired Recebe o registro removido.
+ * @return true se um registro venceu e foi removido.
+ */
+bool presence_expire(presence_table_t *p, uint16_t now_min, uint16_t budget, presence_entry_t *expired);
+
+/**
+ * @brief Retira todos os crachás das zonas [first, first + count), por
+ *        exemplo quando elas são zeradas. Percorre a tabela inteira: O(capacidade).
+ * @return Quantos crachás foram retirados.
+ */
+uint16_t presence_remove_zones(presence_table_t *p, uint16_t first, uint16_t count);
+
+#endif // PRESENCE_H
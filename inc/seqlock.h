@@ -0,0 +1,42 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+// Seqlock: um único escritor (ou escritores já serializados entre si) e
+// leitores em outro core ou em interrupção, sem trava. O escritor deixa a
+// sequência ímpar enquanto altera os dados; o leitor copia o que precisa e
+// repete a cópia se a sequência mudou no meio. O escritor nunca espera.
+typedef struct {
+    volatile uint32_t seq;
+} seqlock_t;
+
+static inline void seqlock_write_begin(seqlock_t *l) {
+    l->seq++;
+    __dmb();
+}
+
+static inline void seqlock_write_end(seqlock_t *l) {
+    __dmb();
+    l->seq++;
+}
+
+// Aguarda o fim de uma escrita em andamento e devolve a sequência lida
+static inline uint32_t seqlock_read_begin(const seqlock_t *l) {
+    uint32_t seq;
+    while ((seq = l->seq) & 1u) tight_loop_contents();
+    __dmb();
+    return seq;
+}
+
+// true se houve escrita desde seqlock_read_begin (a cópia deve ser refeita)
+static inline bool seqlock_read_retry(const seqlock_t *l, uint32_t seq) {
+    __dmb();
+    return l->seq != seq;
+}
+
+#endif // SEQLOCK_H
@@ -0,0 +1,94 @@
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Buckets guardados por andar em cada resolução (filas circulares)
+#define TIMESERIES_MAX_FLOORS   32
+#define TIMESERIES_MINUTES      60       // última hora, minuto a minuto
+#define TIMESERIES_HOURS        24       // último dia, hora a hora
+#define TIMESERIES_DAYS         30       // último mês, dia a dia
+#define TIMESERIES_MAX_POINTS   TIMESERIES_MINUTES  // maior fila (pontos por consulta)
+
+typedef enum {
+    TIMESERIES_MINUTE = 0,
+    TIMESERIES_HOUR,
+    TIMESERIES_DAY,
+    TIMESERIES_LEVELS,
+} timeseries_level_t;
+
+// Resumo de um período: extremos e integral da ocupação (pessoas × segundos,
+// saturada); a média sai da integral dividida pela duração coberta
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t person_s;
+} timeseries_bucket_t;
+
+// Série de um andar. O período p de uma resolução fica no slot p % tamanho;
+// o bucket do período atual de cada resolução é atualizado a cada alteração.
+typedef struct {
+    uint16_t count;                      // ocupação atual (saturada em 65535)
+    uint32_t last_s;                     // instante até onde a integral foi somada
+    timeseries_bucket_t buckets[TIMESERIES_MINUTES + TIMESERIES_HOURS + TIMESERIES_DAYS];
+} timeseries_floor_t;
+
+typedef struct {
+    uint32_t start_s;                    // início da série (períodos anteriores não existem)
+    uint8_t num_floors;
+    timeseries_floor_t floors[TIMESERIES_MAX_FLOORS];
+} timeseries_t;
+
+// Um período devolvido pela consulta
+typedef struct {
+    uint32_t start_s;                    // início do período
+    uint32_t seconds;                    // duração coberta (menor no início da série e no período atual)
+    uint16_t min;
+    uint16_t max;
+    uint32_t person_s;
+} timeseries_point_t;
+
+/**
+ * @brief Começa as séries com a ocupação atual de cada andar.
+ * @param ts Séries.
+ * @param num_floors Quantidade de andares (até TIMESERIES_MAX_FLOORS).
+ * @param now_s Instante atual (segundos desde o boot).
+ * @param counts Ocupação inicial de cada andar.
+ */
+void timeseries_init(timeseries_t *ts, uint8_t num_floors, uint32_t now_s, const uint16_t *counts);
+
+/**
+ * @brief Registra a nova ocupação de um andar, em O(1) por resolução
+ *        (mais um slot por período sem alterações desde a última chamada).
+ * @param ts Séries.
+ * @param floor Índice do andar.
+ * @param now_s Instante da alteração (não decrescente).
+ * @param count Nova ocupação.
+ */
+void timeseries_set(timeseries_t *ts, uint8_t floor, uint32_t now_s, uint32_t count);
+
+/**
+ * @brief Seleciona os períodos guardados que cruzam [from_s, to_s] e fecha a
+ *        integral do andar até now_s.
+ * @param first Recebe o primeiro período (índice absoluto, ver timeseries_point).
+ * @return Quantidade de períodos consecutivos a partir de *first (0 se nenhum).
+ */
+uint32_t timeseries_range(timeseries_t *ts, uint8_t floor, timeseries_level_t level,
+                          uint32_t from_s, uint32_t to_s, uint32_t now_s, uint32_t *first);
+
+/**
+ * @brief Resumo de um período selecionado pela última timeseries_range do andar.
+ * @param period Índice absoluto do período (entre *first e *first + n - 1).
+ * @param point Recebe o resumo.
+ */
+void timeseries_point(const timeseries_t *ts, uint8_t floor, timeseries_level_t level,
+                      uint32_t period, timeseries_point_t *point);
+
+/**
+ * @brief Duração de um período da resolução, em segundos.
+ */
+uint32_t timeseries_period_s(timeseries_level_t level);
+
+#endif // TIMESERIES_H
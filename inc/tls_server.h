@@ -0,0 +1,68 @@
+#ifndef TLS_SERVER_H
+#define TLS_SERVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lwip/altcp.h"
+
+// Sessões completas lembradas para reconhecer retomadas (8 bytes cada). Uma
+// retomada de sessão mais antiga (ticket de horas atrás) conta como completa.
+#define TLS_SERVER_KNOWN_SESSIONS  32
+#define TLS_SERVER_KEY_ID_LEN      8
+
+// Estatísticas do servidor HTTPS. O handshake é medido da conexão TCP aceita
+// até a chegada dos primeiros dados decifrados (a primeira requisição, que o
+// cliente envia assim que recebe o Finished do servidor).
+typedef struct {
+    uint32_t handshakes;         // handshakes concluídos
+    uint32_t resumed;            // dos concluídos, quantos retomaram sessão (cache ou ticket)
+    uint32_t failed;             // conexões encerradas antes da primeira requisição
+    uint32_t last_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint64_t total_ms;           // soma, para a média
+} tls_server_stats_t;
+
+// Estado TLS de uma conexão, guardado pelo chamador junto com a conexão
+typedef struct {
+    uint32_t accepted_ms;        // início do handshake
+    uint8_t key_id[TLS_SERVER_KEY_ID_LEN];  // impressão digital do segredo mestre
+    bool keyed;                  // key_id preenchido
+    bool handshaking;
+} tls_server_conn_t;
+
+/**
+ * @brief Cria um PCB TLS (altcp_tls) com o certificado embutido no build.
+ *        O chamador faz bind/listen/accept como em um PCB TCP comum.
+ * @return PCB ainda não ligado, ou NULL se o certificado/chave for inválido.
+ */
+struct altcp_pcb *tls_server_new(void);
+
+/**
+ * @brief Começa a medir o handshake de uma conexão recém-aceita (chamar na
+ *        callback de accept).
+ * @param tc Estado da conexão; deve continuar válido até tls_server_closed.
+ * @param now_ms Instante atual em ms.
+ */
+void tls_server_accepted(struct altcp_pcb *pcb, tls_server_conn_t *tc, uint32_t now_ms);
+
+/**
+ * @brief Registra o fim do handshake: duração e se a sessão foi retomada.
+ *        Chamar na callback de recepção a cada pbuf; só a primeira chamada
+ *        de cada conexão conta.
+ */
+void tls_server_handshake_done(tls_server_conn_t *tc, uint32_t now_ms);
+
+/**
+ * @brief Avisa que a conexão foi encerrada; conta como falha só se o
+ *        handshake não terminou.
+ */
+void tls_server_closed(tls_server_conn_t *tc);
+
+/**
+ * @brief Estatísticas acumuladas desde o boot.
+ */
+const tls_server_stats_t *tls_server_stats(void);
+
+#endif // TLS_SERVER_H
@@ -0,0 +1,84 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Maior mensagem de dados aceita (comandos de texto curtos)
+#define WS_MAX_MESSAGE        64
+// Payload máximo de frames de controle (RFC 6455 §5.5)
+#define WS_MAX_CONTROL        125
+// Tamanho de Sec-WebSocket-Accept (base64 de 20 bytes) + '\0'
+#define WS_ACCEPT_KEY_SIZE    29
+
+typedef enum {
+    WS_OP_CONTINUATION = 0x0,
+    WS_OP_TEXT         = 0x1,
+    WS_OP_BINARY       = 0x2,
+    WS_OP_CLOSE        = 0x8,
+    WS_OP_PING         = 0x9,
+    WS_OP_PONG         = 0xA,
+} ws_opcode_t;
+
+typedef enum {
+    WS_PARSE_INCOMPLETE = 0,   // precisa de mais bytes
+    WS_PARSE_MESSAGE,          // mensagem completa em msg/ctl (ver opcode)
+    WS_PARSE_ERROR,            // violação de protocolo (ver close_code)
+} ws_parse_result_t;
+
+// Estado do leitor de frames. Mantido por conexão; os bytes do payload são
+// desmascarados enquanto são lidos do pbuf, direto para o destino final.
+typedef struct {
+    uint8_t state;
+    uint8_t hdr_pos;             // bytes lidos do campo atual (tamanho/máscara)
+    uint8_t frame_opcode;
+    bool frame_fin;
+    uint8_t mask[4];
+    uint8_t mask_pos;
+    uint64_t remaining;          // bytes de payload ainda por ler no frame
+
+    // Mensagem entregue ao chamador
+    uint8_t opcode;              // WS_OP_TEXT/BINARY (dados) ou de controle
+    uint8_t msg[WS_MAX_MESSAGE];
+    uint16_t msg_len;
+    uint8_t msg_opcode;          // opcode da mensagem de dados em montagem
+    uint8_t ctl[WS_MAX_CONTROL];
+    uint8_t ctl_len;
+    uint16_t close_code;         // motivo do erro, para o frame de close
+} ws_parser_t;
+
+/**
+ * @brief Prepara o leitor para uma nova conexão.
+ * @param p Estado do leitor.
+ */
+void ws_parser_reset(ws_parser_t *p);
+
+/**
+ * @brief Consome bytes recebidos até completar uma mensagem ou um frame de controle.
+ * @param p Estado do leitor.
+ * @param data Bytes recebidos (payload de um pbuf).
+ * @param len Quantidade de bytes.
+ * @param consumed Recebe quantos bytes foram consumidos.
+ * @return WS_PARSE_MESSAGE quando há mensagem pronta: dados em msg/msg_len se
+ *         opcode for TEXT/BINARY, ou em ctl/ctl_len se for CLOSE/PING/PONG.
+ */
+ws_parse_result_t ws_parser_feed(ws_parser_t *p, const uint8_t *data, size_t len, size_t *consumed);
+
+/**
+ * @brief Calcula Sec-WebSocket-Accept para a chave enviada pelo cliente.
+ * @param client_key Valor de Sec-WebSocket-Key.
+ * @param out Buffer de WS_ACCEPT_KEY_SIZE bytes.
+ */
+void ws_accept_key(const char *client_key, char out[WS_ACCEPT_KEY_SIZE]);
+
+/**
+ * @brief Escreve o cabeçalho de um frame do servidor (sem máscara, FIN=1).
+ * @param out Buffer de pelo menos 4 bytes.
+ * @param opcode Tipo do frame.
+ * @param len Tamanho do payload (até 65535).
+ * @return Quantidade de bytes escritos.
+ */
+size_t ws_frame_header(uint8_t *out, uint8_t opcode, size_t len);
+
+#endif // WEBSOCKET_H
@@ -21,6 +21,9 @@
 #define MEM_ALIGNMENT               4
 #define MEM_SIZE                    4000
 #define MEMP_NUM_TCP_SEG            32
+// PCBs: pool de conexões HTTP (6) + folga para PCBs fechando/em TIME_WAIT
+#define MEMP_NUM_TCP_PCB            10
+#define TCP_LISTEN_BACKLOG          1
 #define MEMP_NUM_ARP_QUEUE          10
 #define PBUF_POOL_SIZE              24
 #define LWIP_ARP                    1
@@ -51,6 +54,25 @@
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
+// altcp: o servidor HTTP usa a mesma API sobre TCP puro (altcp_tcp) e TLS
+#define LWIP_ALTCP                  1
+#define MEMP_NUM_ALTCP_PCB          (2 * MEMP_NUM_TCP_PCB)  // conexão TLS = 2 (TLS + TCP)
+
+// HTTPS opcional (cmake -DCHECKIN_HTTPS=ON). O handshake completo custa segundos
+// de CPU no RP2040; com cache de sessões e tickets o cliente que volta faz só o
+// handshake abreviado.
+#if HTTPS_ENABLED
+#define LWIP_ALTCP_TLS              1
+#define LWIP_ALTCP_TLS_MBEDTLS      1
+#define ALTCP_MBEDTLS_AUTHMODE      MBEDTLS_SSL_VERIFY_NONE  // servidor não pede certificado do cliente
+#define ALTCP_MBEDTLS_USE_SESSION_CACHE              1
+#define ALTCP_MBEDTLS_SESSION_CACHE_SIZE             8
+#define ALTCP_MBEDTLS_SESSION_CACHE_TIMEOUT_SECONDS  (60 * 60)
+#define ALTCP_MBEDTLS_USE_SESSION_TICKETS            1
+#define ALTCP_MBEDTLS_SESSION_TICKET_CIPHER          MBEDTLS_CIPHER_AES_256_GCM
+#define ALTCP_MBEDTLS_SESSION_TICKET_TIMEOUT_SECONDS (24 * 60 * 60)
+#endif
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
 #define LWIP_STATS                  1
@@ -0,0 +1,63 @@
+#ifndef MBEDTLS_CONFIG_H
+#define MBEDTLS_CONFIG_H
+
+// Configuração do mbedTLS para o servidor HTTPS (usada só com CHECKIN_HTTPS=ON).
+// Mínima de propósito: TLS 1.2, servidor, ECDHE-ECDSA com P-256 e AES-GCM.
+// Um único conjunto de cifras e uma única curva mantêm o código e a RAM do
+// handshake pequenos; cache de sessões e tickets permitem a retomada.
+
+/* ─── PLATAFORMA ─────────────────────────────────────────────────────── */
+#define MBEDTLS_HAVE_TIME
+#define MBEDTLS_PLATFORM_C
+#define MBEDTLS_NO_PLATFORM_ENTROPY
+#define MBEDTLS_ENTROPY_HARDWARE_ALT       // mbedtls_hardware_poll do pico_mbedtls
+#define MBEDTLS_AES_FEWER_TABLES           // ~6 KB a menos de tabelas AES na flash
+#define MBEDTLS_ECP_NIST_OPTIM
+
+/* ─── TLS ────────────────────────────────────────────────────────────── */
+#define MBEDTLS_SSL_TLS_C
+#define MBEDTLS_SSL_SRV_C
+#define MBEDTLS_SSL_PROTO_TLS1_2
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+#define MBEDTLS_SSL_EXTENDED_MASTER_SECRET
+#define MBEDTLS_SSL_SERVER_NAME_INDICATION
+#define MBEDTLS_SSL_CIPHERSUITES           MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256
+
+// Retomada de sessão: cache no servidor (session ID) e tickets (RFC 5077)
+#define MBEDTLS_SSL_CACHE_C
+#define MBEDTLS_SSL_TICKET_C
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+// Registros de até 4 KB (o padrão de 16 KB por sentido não cabe em várias
+// conexões); respostas maiores são divididas em vários registros
+#define MBEDTLS_SSL_IN_CONTENT_LEN         4096
+#define MBEDTLS_SSL_OUT_CONTENT_LEN        4096
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+
+/* ─── CRIPTOGRAFIA ───────────────────────────────────────────────────── */
+#define MBEDTLS_AES_C
+#define MBEDTLS_GCM_C
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_MD_C
+#define MBEDTLS_SHA224_C
+#define MBEDTLS_SHA256_C
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_CTR_DRBG_C
+#define MBEDTLS_ENTROPY_C
+
+/* ─── CERTIFICADO E CHAVE (PEM) ──────────────────────────────────────── */
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+#define MBEDTLS_PEM_PARSE_C
+#define MBEDTLS_BASE64_C
+#define MBEDTLS_X509_USE_C
+#define MBEDTLS_X509_CRT_PARSE_C
+
+#endif // MBEDTLS_CONFIG_H
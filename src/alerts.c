@@ -0,0 +1,226 @@
+/**
+ * Regras de alerta por andar (acima/abaixo de um limite, opcionalmente por um
+ * tempo mínimo), avaliadas só nas transições.
+ *
+ * Nada é varrido periodicamente: uma alteração de ocupação reavalia apenas as
+ * regras do andar que mudou (máscara por andar), e as regras com tempo mínimo
+ * ficam pendentes com um prazo. O menor prazo fica em next_due_s, então o loop
+ * principal só chama alerts_poll quando alguma pendente pode de fato disparar.
+ * Quem consome os alertas retira as mudanças com alerts_next_change, como os
+ * andares alterados do modelo (building_next_dirty).
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "alerts.h"
+
+#define BIT_SET(m, i)    ((m)[(i) / 32] |= 1u << ((i) % 32))
+#define BIT_CLEAR(m, i)  ((m)[(i) / 32] &= ~(1u << ((i) % 32)))
+
+_Static_assert(ALERTS_MAX_RULES <= UINT8_MAX, "num_rules e de 8 bits");
+
+/* ─── CARGA ──────────────────────────────────────────────────────────── */
+static void skip_spaces(const char **p, const char *end) {
+    while (*p < end && (**p == ' ' || **p == '\t')) (*p)++;
+}
+
+// Número decimal até max seguido de espaço ou fim da linha
+static bool parse_number(const char **p, const char *end, uint32_t max, uint32_t *out) {
+    const char *s = *p;
+    uint32_t v = 0;
+    for (; s < end && isdigit((unsigned char)*s); s++) {
+        v = v * 10 + (uint32_t)(*s - '0');
+        if (v > max) return false;
+    }
+    if (s == *p || (s < end && *s != ' ' && *s != '\t')) return false;
+    *p = s;
+    *out = v;
+    skip_spaces(p, end);
+    return true;
+}
+
+// Interpreta uma linha já sem espaços nas pontas (len > 0)
+static bool load_line(alerts_t *a, const char *line, size_t len, uint8_t num_floors) {
+    const char *end = line + len;
+    alert_rule_t r = { 0 };
+    if (len > 6 && memcmp(line, "above", 5) == 0 && (line[5] == ' ' || line[5] == '\t')) {
+        r.kind = ALERT_ABOVE;
+    } else if (len > 6 && memcmp(line, "below", 5) == 0 && (line[5] == ' ' || line[5] == '\t')) {
+        r.kind = ALERT_BELOW;
+    } else {
+        return false;
+    }
+    const char *p = line + 5;
+    skip_spaces(&p, end);
+
+    // Andar: índice ou "*" (todos)
+    uint32_t floor = 0;
+    bool all = false;
+    if (*p == '*') {
+        all = true;
+        p++;
+        if (p < end && *p != ' ' && *p != '\t') return false;
+        skip_spaces(&p, end);
+    } else if (!parse_number(&p, end, num_floors - 1u, &floor)) {
+        return false;
+    }
+
+    uint32_t limit, hysteresis = 0, hold_s = 0;
+    if (!parse_number(&p, end, UINT16_MAX, &limit)) return false;
+    if (p < end && !parse_number(&p, end, UINT16_MAX, &hysteresis)) return false;
+    if (p < end && !parse_number(&p, end, 7 * 86400, &hold_s)) return false;
+    if (p < end) return false;
+    // Regras que nunca disparariam ou nunca voltariam ao normal
+    if (r.kind == ALERT_ABOVE && hysteresis > limit) return false;
+    if (r.kind == ALERT_BELOW && limit == 0) return false;
+    r.limit = (uint16_t)limit;
+    r.hysteresis = (uint16_t)hysteresis;
+    r.hold_s = hold_s;
+
+    uint8_t first = all ? 0 : (uint8_t)floor;
+    uint8_t last = all ? num_floors - 1 : (uint8_t)floor;
+    for (uint8_t f = first; f <= last; f++) {
+        if (a->num_rules >= ALERTS_MAX_RULES) return false;
+        uint8_t i = a->num_rules++;
+        a->rules[i] = r;
+        a->rules[i].floor = f;
+        BIT_SET(a->floor_rules[f], i);
+    }
+    return true;
+}
+
+bool alerts_load(alerts_t *a, const char *text, uint8_t num_floors, unsigned *error_line) {
+    memset(a, 0, sizeof(*a));
+    a->next_due_s = UINT32_MAX;
+    *error_line = 0;
+    if (num_floors == 0 || num_floors > ALERTS_MAX_FLOORS) return false;
+
+    unsigned line_no = 0;
+    const char *p = text;
+    while (*p) {
+        const char *nl = strchr(p, '\n');
+        const char *end = nl ? nl : p + strlen(p);
+        line_no++;
+        const char *s = p;
+        while (s < end && isspace((unsigned char)*s)) s++;
+        const char *e = end;
+        while (e > s && isspace((unsigned char)e[-1])) e--;
+        if (e > s && *s != '#' && !load_line(a, s, (size_t)(e - s), num_floors)) {
+            *error_line = line_no;
+            memset(a, 0, sizeof(*a));
+            a->next_due_s = UINT32_MAX;
+            return false;
+        }
+        p = nl ? nl + 1 : end;
+    }
+    return true;
+}
+
+/* ─── AVALIAÇÃO ──────────────────────────────────────────────────────── */
+static bool condition(const alert_rule_t *r, uint32_t count) {
+    return (r->kind == ALERT_ABOVE) ? count > r->limit : count < r->limit;
+}
+
+static bool released(const alert_rule_t *r, uint32_t count) {
+    return (r->kind == ALERT_ABOVE) ? count + r->hysteresis <= r->limit
+                                    : count >= (uint32_t)r->limit + r->hysteresis;
+}
+
+static void set_state(alerts_t *a, uint8_t i, alert_state_t state, uint32_t since_s) {
+    alert_rule_t *r = &a->rules[i];
+    if (r->state == ALERT_ACTIVE) {
+        BIT_CLEAR(a->active, i);
+        a->num_active--;
+        BIT_SET(a->changed, i);
+    } else if (r->state == ALERT_PENDING) {
+        // O prazo em next_due_s pode ficar para trás: alerts_poll o recalcula
+        BIT_CLEAR(a->pending, i);
+    }
+    r->state = (uint8_t)state;
+    r->since_s = since_s;
+    if (state == ALERT_ACTIVE) {
+        BIT_SET(a->active, i);
+        a->num_active++;
+        BIT_SET(a->changed, i);
+    } else if (state == ALERT_PENDING) {
+        BIT_SET(a->pending, i);
+        uint32_t due = since_s + r->hold_s;
+        if (due < a->next_due_s) a->next_due_s = due;
+    }
+}
+
+void alerts_update(alerts_t *a, uint8_t floor, uint32_t count, uint32_t now_s) {
+    if (floor >= ALERTS_MAX_FLOORS) return;
+    for (int w = 0; w < ALERTS_WORDS; w++) {
+        uint32_t bits = a->floor_rules[floor][w];
+        while (bits) {
+            uint8_t i = (uint8_t)(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            const alert_rule_t *r = &a->rules[i];
+            switch (r->state) {
+            case ALERT_IDLE:
+                if (!condition(r, count)) break;
+                if (r->hold_s == 0) set_state(a, i, ALERT_ACTIVE, now_s);
+                else set_state(a, i, ALERT_PENDING, now_s);
+                break;
+            case ALERT_PENDING:
+                // O tempo mínimo exige a condição sem interrupção
+                if (!condition(r, count)) set_state(a, i, ALERT_IDLE, now_s);
+                else if (now_s - r->since_s >= r->hold_s) set_state(a, i, ALERT_ACTIVE, r->since_s + r->hold_s);
+                break;
+            case ALERT_ACTIVE:
+                if (released(r, count)) set_state(a, i, ALERT_IDLE, now_s);
+                break;
+            }
+        }
+    }
+}
+
+bool alerts_poll(alerts_t *a, uint32_t now_s) {
+    if (now_s < a->next_due_s) return false;
+    bool changed = false;
+    uint32_t next = UINT32_MAX;
+    for (int w = 0; w < ALERTS_WORDS; w++) {
+        uint32_t bits = a->pending[w];
+        while (bits) {
+            uint8_t i = (uint8_t)(w * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+            const alert_rule_t *r = &a->rules[i];
+            uint32_t due = r->since_s + r->hold_s;
+            if (now_s >= due) {
+                set_state(a, i, ALERT_ACTIVE, due);
+                changed = true;
+            } else if (due < next) {
+                next = due;
+            }
+        }
+    }
+    a->next_due_s = next;
+    return changed;
+}
+
+int alerts_next_change(alerts_t *a, bool *active) {
+    for (int w = 0; w < ALERTS_WORDS; w++) {
+        while (a->changed[w]) {
+            int bit = __builtin_ctz(a->changed[w]);
+            a->changed[w] &= a->changed[w] - 1;
+            uint32_t mask = 1u << bit;
+            if ((a->active[w] ^ a->reported[w]) & mask) {
+                a->reported[w] ^= mask;
+                *active = (a->active[w] & mask) != 0;
+                return w * 32 + bit;
+            }
+        }
+    }
+    return -1;
+}
+
+int alerts_first_active(const alerts_t *a, const uint32_t *active, uint8_t floor) {
+    if (floor >= ALERTS_MAX_FLOORS) return -1;
+    for (int w = 0; w < ALERTS_WORDS; w++) {
+        uint32_t bits = a->floor_rules[floor][w] & active[w];
+        if (bits) return w * 32 + __builtin_ctz(bits);
+    }
+    return -1;
+}
@@ -0,0 +1,167 @@
+/**
+ * Modelo do prédio: prédios, andares e zonas com capacidade própria.
+ *
+ * A configuração é lida uma vez no boot. Os nomes não são copiados (guardam só
+ * a posição no texto, que fica na flash) e os contadores são de 16 bits, então
+ * centenas de zonas cabem em poucos KB de RAM fixa. O total de cada andar é
+ * atualizado junto com a zona, para que quem mostra a ocupação (página, OLED,
+ * matriz) percorra só os andares.
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "building.h"
+
+static void mark_dirty(building_model_t *m, uint8_t floor) {
+    m->dirty[floor / 32] |= 1u << (floor % 32);
+}
+
+// Nome válido: não vazio, sem caracteres que precisariam de escape em JSON ou HTML
+static bool name_ok(const char *s, size_t len) {
+    if (len == 0 || len > BUILDING_NAME_MAX) return false;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c < 0x20 || c == '"' || c == '\\' || c == '<' || c == '>' || c == '&') return false;
+    }
+    return true;
+}
+
+// Termina o andar atual: sem zonas declaradas, ganha uma zona com o nome dele
+static bool close_floor(building_model_t *m) {
+    if (m->num_floors == 0) return true;
+    building_floor_t *f = &m->floors[m->num_floors - 1];
+    if (f->num_zones > 0) return true;
+    if (m->num_zones >= BUILDING_MAX_ZONES) return false;
+    uint16_t z = m->num_zones++;
+    m->zone_names[z] = f->name;
+    m->zone_floor[z] = (uint8_t)(m->num_floors - 1);
+    m->zone_capacity[z] = BUILDING_DEFAULT_CAPACITY;
+    f->num_zones = 1;
+    f->capacity = BUILDING_DEFAULT_CAPACITY;
+    return true;
+}
+
+// Interpreta uma linha já sem espaços nas pontas (len > 0)
+static bool load_line(building_model_t *m, const char *line, size_t len) {
+    const char *end = line + len;
+    const char *kw_end = line;
+    while (kw_end < end && *kw_end != ' ' && *kw_end != '\t') kw_end++;
+    size_t kw_len = (size_t)(kw_end - line);
+    const char *arg = kw_end;
+    while (arg < end && (*arg == ' ' || *arg == '\t')) arg++;
+
+    if (kw_len == 8 && memcmp(line, "building", 8) == 0) {
+        if (!close_floor(m) || m->num_buildings >= BUILDING_MAX_BUILDINGS) return false;
+        if (!name_ok(arg, (size_t)(end - arg))) return false;
+        building_t *b = &m->buildings[m->num_buildings++];
+        b->name = (building_name_t){ (uint16_t)(arg - m->source), (uint8_t)(end - arg) };
+        b->first_floor = m->num_floors;
+        b->num_floors = 0;
+        return true;
+    }
+    if (kw_len == 5 && memcmp(line, "floor", 5) == 0) {
+        if (!close_floor(m) || m->num_floors >= BUILDING_MAX_FLOORS) return false;
+        if (!name_ok(arg, (size_t)(end - arg))) return false;
+        if (m->num_buildings == 0) {
+            // Andares antes de qualquer "building": prédio sem nome
+            m->buildings[0] = (building_t){ { 0, 0 }, 0, 0 };
+            m->num_buildings = 1;
+        }
+        building_t *b = &m->buildings[m->num_buildings - 1];
+        building_floor_t *f = &m->floors[m->num_floors++];
+        memset(f, 0, sizeof(*f));
+        f->name = (building_name_t){ (uint16_t)(arg - m->source), (uint8_t)(end - arg) };
+        f->building = (uint8_t)(m->num_buildings - 1);
+        f->first_zone = m->num_zones;
+        b->num_floors++;
+        return true;
+    }
+    if (kw_len == 4 && memcmp(line, "zone", 4) == 0) {
+        if (m->num_floors == 0 || m->num_zones >= BUILDING_MAX_ZONES) return false;
+        uint32_t cap = 0;
+        const char *p = arg;
+        for (; p < end && isdigit((unsigned char)*p); p++) {
+            cap = cap * 10 + (uint32_t)(*p - '0');
+            if (cap > UINT16_MAX) return false;
+        }
+        if (p == arg || cap == 0 || p == end || (*p != ' ' && *p != '\t')) return false;
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (!name_ok(p, (size_t)(end - p))) return false;
+        building_floor_t *f = &m->floors[m->num_floors - 1];
+        uint16_t z = m->num_zones++;
+        m->zone_names[z] = (building_name_t){ (uint16_t)(p - m->source), (uint8_t)(end - p) };
+        m->zone_floor[z] = (uint8_t)(m->num_floors - 1);
+        m->zone_capacity[z] = (uint16_t)cap;
+        f->num_zones++;
+        f->capacity += cap;
+        return true;
+    }
+    return false;
+}
+
+bool building_load(building_model_t *m, const char *text, unsigned *error_line) {
+    memset(m, 0, sizeof(*m));
+    m->source = text;
+    *error_line = 0;
+    if (strlen(text) > UINT16_MAX) return false;  // offsets dos nomes são de 16 bits
+
+    unsigned line_no = 0;
+    const char *p = text;
+    while (*p) {
+        const char *nl = strchr(p, '\n');
+        const char *end = nl ? nl : p + strlen(p);
+        line_no++;
+        const char *s = p;
+        while (s < end && isspace((unsigned char)*s)) s++;
+        const char *e = end;
+        while (e > s && isspace((unsigned char)e[-1])) e--;
+        if (e > s && *s != '#' && !load_line(m, s, (size_t)(e - s))) {
+            *error_line = line_no;
+            return false;
+        }
+        p = nl ? nl + 1 : end;
+    }
+    if (!close_floor(m)) return false;
+    return m->num_floors > 0;
+}
+
+int building_zone_index(const building_model_t *m, int floor, int zone) {
+    if (floor < 0 || floor >= m->num_floors) return -1;
+    const building_floor_t *f = &m->floors[floor];
+    if (zone < 0 || zone >= f->num_zones) return -1;
+    return f->first_zone + zone;
+}
+
+uint16_t building_zone_set(building_model_t *m, uint16_t zone, int32_t value) {
+    if (value < 0) value = 0;
+    if (value > m->zone_capacity[zone]) value = m->zone_capacity[zone];
+    uint16_t old = m->zone_count[zone];
+    if (old != (uint16_t)value) {
+        uint8_t floor = m->zone_floor[zone];
+        m->zone_count[zone] = (uint16_t)value;
+        m->floors[floor].count = m->floors[floor].count - old + (uint32_t)value;
+        mark_dirty(m, floor);
+    }
+    return (uint16_t)value;
+}
+
+void building_recount(building_model_t *m) {
+    for (uint8_t f = 0; f < m->num_floors; f++) m->floors[f].count = 0;
+    for (uint16_t z = 0; z < m->num_zones; z++) {
+        if (m->zone_count[z] > m->zone_capacity[z]) m->zone_count[z] = m->zone_capacity[z];
+        m->floors[m->zone_floor[z]].count += m->zone_count[z];
+    }
+    memset(m->dirty, 0, sizeof(m->dirty));
+}
+
+int building_next_dirty(building_model_t *m) {
+    for (size_t w = 0; w < sizeof(m->dirty) / sizeof(m->dirty[0]); w++) {
+        if (m->dirty[w]) {
+            int bit = __builtin_ctz(m->dirty[w]);
+            m->dirty[w] &= m->dirty[w] - 1;
+            return (int)(w * 32) + bit;
+        }
+    }
+    return -1;
+}
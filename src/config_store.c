@@ -0,0 +1,131 @@
+/**
+ * Configuração do prédio gravada em flash, para trocar andares e zonas sem
+ * recompilar.
+ *
+ * Dois setores usados em rodízio, como os snapshots de flash_store.c: cada
+ * gravação apaga o setor que não está em uso, programa o texto e só então o
+ * cabeçalho, com sequência maior. No boot vale o setor com cabeçalho válido e
+ * maior sequência; o texto é usado direto da flash pelo XIP, e como o setor em
+ * uso nunca é regravado, os nomes do modelo continuam válidos até reiniciar.
+ */
+
+#include <string.h>
+
+#include "pico/flash.h"
+
+#include "config_store.h"
+
+#define CONFIG_MAGIC            0x47464331u   // "1CFG"
+#define SAFE_EXECUTE_TIMEOUT_MS 100
+
+// Cabeçalho do setor (início da página 0)
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;                // maior = mais recente
+    uint32_t len;                // bytes de texto, sem o '\0'
+    uint32_t text_hash;          // flash_store_hash do texto
+    uint32_t header_hash;        // flash_store_hash dos campos acima
+} config_header_t;
+
+// Operação executada por flash_safe_execute (com o XIP parado)
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+} flash_op_t;
+
+// Fim do programa gravado na flash (definido pelo linker script do SDK)
+extern char __flash_binary_end;
+
+// Imagem da página em gravação
+static uint8_t page[FLASH_PAGE_SIZE];
+
+static uint32_t sector_offset(uint8_t sector) {
+    return CONFIG_STORE_OFFSET + (uint32_t)sector * FLASH_SECTOR_SIZE;
+}
+
+static const void *flash_ptr(uint32_t offset) {
+    return (const void *)(uintptr_t)(XIP_BASE + offset);
+}
+
+static bool header_ok(uint8_t sector) {
+    const config_header_t *h = flash_ptr(sector_offset(sector));
+    if (h->magic != CONFIG_MAGIC || h->len > CONFIG_STORE_MAX) return false;
+    if (h->header_hash != flash_store_hash(h, offsetof(config_header_t, header_hash))) return false;
+    const char *text = flash_ptr(sector_offset(sector) + FLASH_PAGE_SIZE);
+    return text[h->len] == '\0' && h->text_hash == flash_store_hash(text, h->len);
+}
+
+// Setor válido com a maior sequência, ou -1
+static int newest_sector(void) {
+    int best = -1;
+    uint32_t best_seq = 0;
+    for (uint8_t i = 0; i < CONFIG_STORE_SECTORS; i++) {
+        if (!header_ok(i)) continue;
+        const config_header_t *h = flash_ptr(sector_offset(i));
+        if (best < 0 || (int32_t)(h->seq - best_seq) > 0) {
+            best = i;
+            best_seq = h->seq;
+        }
+    }
+    return best;
+}
+
+/* ─── ACESSO À FLASH ─────────────────────────────────────────────────── */
+static void do_erase(void *param) {
+    const flash_op_t *op = param;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void do_program(void *param) {
+    const flash_op_t *op = param;
+    flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+static bool flash_op(void (*fn)(void *), uint32_t offset, const uint8_t *data) {
+    flash_op_t op = { offset, data };
+    return flash_safe_execute(fn, &op, SAFE_EXECUTE_TIMEOUT_MS) == PICO_OK;
+}
+
+/* ─── API ────────────────────────────────────────────────────────────── */
+const char *config_store_load(void) {
+    if ((uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE) > CONFIG_STORE_OFFSET) return NULL;
+    int sector = newest_sector();
+    if (sector < 0) return NULL;
+    const config_header_t *h = flash_ptr(sector_offset((uint8_t)sector));
+    if (h->len == 0) return NULL;
+    return flash_ptr(sector_offset((uint8_t)sector) + FLASH_PAGE_SIZE);
+}
+
+bool config_store_save(const char *text, size_t len) {
+    if (len > CONFIG_STORE_MAX ||
+        (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE) > CONFIG_STORE_OFFSET) {
+        return false;
+    }
+    int current = newest_sector();
+    uint32_t seq = 0;
+    if (current >= 0) seq = ((const config_header_t *)flash_ptr(sector_offset((uint8_t)current)))->seq;
+    uint8_t next = (uint8_t)((current + 1) % CONFIG_STORE_SECTORS);
+    uint32_t base = sector_offset(next);
+    if (!flash_op(do_erase, base, NULL)) return false;
+
+    // Texto e o '\0' final (a página apagada já vale 0xFF, então o zero é gravado)
+    for (size_t start = 0; start <= len; start += FLASH_PAGE_SIZE) {
+        size_t n = len - start < FLASH_PAGE_SIZE ? len - start : FLASH_PAGE_SIZE;
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page, text + start, n);
+        if (n < FLASH_PAGE_SIZE) page[n] = '\0';
+        if (!flash_op(do_program, base + FLASH_PAGE_SIZE + (uint32_t)start, page)) return false;
+    }
+
+    // Cabeçalho por último: só a partir daqui a configuração nova vale
+    config_header_t h = {
+        .magic = CONFIG_MAGIC,
+        .seq = seq + 1,
+        .len = (uint32_t)len,
+        .text_hash = flash_store_hash(text, len),
+    };
+    h.header_hash = flash_store_hash(&h, offsetof(config_header_t, header_hash));
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &h, sizeof(h));
+    return flash_op(do_program, base, page);
+}
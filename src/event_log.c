@@ -0,0 +1,30 @@
+/**
+ * Histórico de alterações de ocupação em fila circular, sem alocação.
+ *
+ * Cada alteração vira um registro de 8 bytes; a leitura é feita por cursor (o
+ * número de sequência), então um cliente busca só o que veio depois da última
+ * leitura em vez de comparar estados inteiros.
+ */
+
+#include "event_log.h"
+
+_Static_assert((EVENT_LOG_CAPACITY & (EVENT_LOG_CAPACITY - 1)) == 0, "EVENT_LOG_CAPACITY deve ser potencia de 2");
+_Static_assert(sizeof(event_record_t) == 8, "event_record_t deve ter 8 bytes");
+
+void event_log_append(event_log_t *log, uint32_t time_s, uint16_t zone, int32_t delta, event_source_t source) {
+    event_record_t *r = &log->records[log->next_seq & (EVENT_LOG_CAPACITY - 1)];
+    r->time_s = time_s;
+    r->zone = zone;
+    r->source = source;
+    r->delta = delta;
+    log->next_seq++;
+}
+
+uint32_t event_log_oldest(const event_log_t *log) {
+    return (log->next_seq > EVENT_LOG_CAPACITY) ? log->next_seq - EVENT_LOG_CAPACITY : 0;
+}
+
+const event_record_t *event_log_get(const event_log_t *log, uint32_t seq) {
+    if (seq < event_log_oldest(log) || seq >= log->next_seq) return NULL;
+    return &log->records[seq & (EVENT_LOG_CAPACITY - 1)];
+}
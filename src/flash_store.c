@@ -0,0 +1,278 @@
+/**
+ * Persistência da ocupação em flash, estruturada como log.
+ *
+ * Cada alteração vira um registro de 4 bytes acrescentado ao setor ativo;
+ * quando o setor enche, os contadores atuais são gravados como snapshot no
+ * setor seguinte (rodízio entre FLASH_STORE_SECTORS setores, o que distribui
+ * os apagamentos). O cabeçalho do setor é a última coisa programada, então um
+ * snapshot interrompido por queda de energia nunca é considerado válido e o
+ * setor anterior continua valendo.
+ *
+ * As gravações acontecem só em flash_store_flush, chamado pelo loop principal:
+ * apagar ou programar a flash para o XIP, e isso não pode cair nas callbacks
+ * do lwIP nem na leitura dos botões. A recuperação no boot só lê a flash pelo
+ * XIP (cabeçalhos, um snapshot e o log), sem apagar nada.
+ */
+
+#include <string.h>
+
+#include "pico/flash.h"
+
+#include "flash_store.h"
+
+#define STORE_MAGIC             0x4B484331u   // "1CHK"
+#define PAGES_PER_SECTOR        (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define RECORDS_PER_PAGE        (FLASH_PAGE_SIZE / 4)
+#define RECORD_END              0xFFFFFFFFu   // palavra apagada: fim do log
+#define SAFE_EXECUTE_TIMEOUT_MS 100
+
+// Registro do log: índice (11 bits), verificação (5 bits), valor novo (16 bits)
+#define RECORD_INDEX(r)         ((r) & 0x7FFu)
+#define RECORD_CHECK(r)         (((r) >> 11) & 0x1Fu)
+#define RECORD_VALUE(r)         ((uint16_t)((r) >> 16))
+
+_Static_assert(FLASH_STORE_MAX_VALUES <= 0x7FF, "indice nao cabe no registro");
+_Static_assert(1 + (FLASH_STORE_MAX_VALUES * 2 + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE < PAGES_PER_SECTOR,
+               "snapshot nao deixa espaco para o log");
+
+// Cabeçalho do setor (início da página 0)
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;                // maior = mais recente
+    uint32_t config_hash;
+    uint16_t num_values;
+    uint16_t reserved;
+    uint32_t snapshot_crc;       // CRC-32 dos num_values contadores
+    uint32_t header_crc;         // CRC-32 dos campos acima
+} store_header_t;
+
+// Operação executada por flash_safe_execute (com o XIP parado)
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+} flash_op_t;
+
+// Fim do programa gravado na flash (definido pelo linker script do SDK)
+extern char __flash_binary_end;
+
+/* ─── AUXILIARES ─────────────────────────────────────────────────────── */
+uint32_t flash_store_hash(const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint32_t h = 2166136261u;
+    while (len--) h = (h ^ *p++) * 16777619u;
+    return h;
+}
+
+// CRC-32 (polinômio refletido 0xEDB88320), tabela de 16 entradas
+static uint32_t crc32(const void *data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static uint32_t record_check(uint32_t index, uint32_t value) {
+    uint32_t x = index * 31u + value;
+    return (x ^ (x >> 5) ^ (x >> 10) ^ (x >> 15) ^ 0x15u) & 0x1Fu;
+}
+
+static uint32_t make_record(uint16_t index, uint16_t value) {
+    return (uint32_t)index | (record_check(index, value) << 11) | ((uint32_t)value << 16);
+}
+
+static bool record_ok(const flash_store_t *s, uint32_t r) {
+    return RECORD_INDEX(r) < s->num_values &&
+           RECORD_CHECK(r) == record_check(RECORD_INDEX(r), RECORD_VALUE(r));
+}
+
+static uint32_t sector_offset(uint8_t sector) {
+    return FLASH_STORE_OFFSET + (uint32_t)sector * FLASH_SECTOR_SIZE;
+}
+
+static const void *flash_ptr(uint32_t offset) {
+    return (const void *)(uintptr_t)(XIP_BASE + offset);
+}
+
+static uint16_t snapshot_pages(const flash_store_t *s) {
+    return (uint16_t)((s->num_values * 2u + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE);
+}
+
+static uint16_t first_log_page(const flash_store_t *s) {
+    return (uint16_t)(1 + snapshot_pages(s));
+}
+
+static void reset_page(flash_store_t *s) {
+    memset(s->page, 0xFF, sizeof(s->page));
+    s->page_used = 0;
+}
+
+/* ─── ACESSO À FLASH ─────────────────────────────────────────────────── */
+static void do_erase(void *param) {
+    const flash_op_t *op = param;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void do_program(void *param) {
+    const flash_op_t *op = param;
+    flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+static bool erase_sector(uint8_t sector) {
+    flash_op_t op = { sector_offset(sector), NULL };
+    return flash_safe_execute(do_erase, &op, SAFE_EXECUTE_TIMEOUT_MS) == PICO_OK;
+}
+
+// Programa uma página inteira a partir de um buffer em RAM. Reprogramar uma
+// página já parcialmente gravada é seguro desde que os bytes antigos se
+// repitam: a programação só leva bits de 1 para 0.
+static bool program_page(uint8_t sector, uint16_t page, const void *data) {
+    flash_op_t op = { sector_offset(sector) + (uint32_t)page * FLASH_PAGE_SIZE, data };
+    return flash_safe_execute(do_program, &op, SAFE_EXECUTE_TIMEOUT_MS) == PICO_OK;
+}
+
+/* ─── SNAPSHOT ───────────────────────────────────────────────────────── */
+static bool header_ok(const flash_store_t *s, uint8_t sector) {
+    const store_header_t *h = flash_ptr(sector_offset(sector));
+    if (h->magic != STORE_MAGIC || h->config_hash != s->config_hash || h->num_values != s->num_values) {
+        return false;
+    }
+    if (h->header_crc != crc32(h, offsetof(store_header_t, header_crc))) return false;
+    const void *snapshot = flash_ptr(sector_offset(sector) + FLASH_PAGE_SIZE);
+    return h->snapshot_crc == crc32(snapshot, s->num_values * 2u);
+}
+
+// Grava os contadores atuais no próximo setor e passa a usá-lo. O log
+// anterior deixa de ser necessário, então as alterações pendentes são
+// descartadas (já estão nos contadores).
+static bool compact(flash_store_t *s) {
+    uint8_t next = (uint8_t)((s->sector + 1) % FLASH_STORE_SECTORS);
+    const uint8_t *bytes = (const uint8_t *)s->values;
+    size_t size = s->num_values * 2u;
+
+    s->compact_needed = true;
+    if (!erase_sector(next)) return false;
+    for (uint16_t p = 0; p < snapshot_pages(s); p++) {
+        size_t start = (size_t)p * FLASH_PAGE_SIZE;
+        size_t n = size - start < FLASH_PAGE_SIZE ? size - start : FLASH_PAGE_SIZE;
+        memset(s->page, 0xFF, sizeof(s->page));
+        memcpy(s->page, bytes + start, n);
+        if (!program_page(next, (uint16_t)(1 + p), s->page)) return false;
+    }
+
+    // Cabeçalho por último: só a partir daqui o setor novo vale
+    store_header_t h = {
+        .magic = STORE_MAGIC,
+        .seq = s->seq + 1,
+        .config_hash = s->config_hash,
+        .num_values = s->num_values,
+        .reserved = 0xFFFF,
+        .snapshot_crc = crc32(s->values, size),
+    };
+    h.header_crc = crc32(&h, offsetof(store_header_t, header_crc));
+    memset(s->page, 0xFF, sizeof(s->page));
+    memcpy(s->page, &h, sizeof(h));
+    if (!program_page(next, 0, s->page)) return false;
+
+    s->sector = next;
+    s->seq = h.seq;
+    s->log_page = first_log_page(s);
+    reset_page(s);
+    s->num_pending = 0;
+    s->compact_needed = false;
+    s->compactions++;
+    return true;
+}
+
+/* ─── API ────────────────────────────────────────────────────────────── */
+bool flash_store_init(flash_store_t *s, uint16_t *values, uint16_t num_values, uint32_t config_hash) {
+    memset(s, 0, sizeof(*s));
+    s->values = values;
+    s->num_values = num_values;
+    s->config_hash = config_hash;
+    s->enabled = num_values > 0 && num_values <= FLASH_STORE_MAX_VALUES &&
+                 (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE) <= FLASH_STORE_OFFSET;
+    reset_page(s);
+    if (!s->enabled) return false;
+
+    // Setor válido com a maior sequência (comparação tolerante à volta do contador)
+    int best = -1;
+    for (uint8_t i = 0; i < FLASH_STORE_SECTORS; i++) {
+        if (!header_ok(s, i)) continue;
+        const store_header_t *h = flash_ptr(sector_offset(i));
+        if (best < 0 || (int32_t)(h->seq - s->seq) > 0) {
+            best = i;
+            s->seq = h->seq;
+        }
+    }
+    if (best < 0) {
+        // Nada salvo (ou configuração diferente): começa do zero no setor 0
+        memset(values, 0, num_values * 2u);
+        s->sector = FLASH_STORE_SECTORS - 1;
+        s->seq = 0;
+        s->compact_needed = true;
+        return false;
+    }
+    s->sector = (uint8_t)best;
+    memcpy(values, flash_ptr(sector_offset(s->sector) + FLASH_PAGE_SIZE), num_values * 2u);
+
+    // Reaplica o log até a primeira palavra apagada
+    uint16_t first = first_log_page(s);
+    const uint32_t *log = flash_ptr(sector_offset(s->sector) + (uint32_t)first * FLASH_PAGE_SIZE);
+    uint32_t max = (uint32_t)(PAGES_PER_SECTOR - first) * RECORDS_PER_PAGE;
+    uint32_t k = 0;
+    for (; k < max && log[k] != RECORD_END; k++) {
+        if (!record_ok(s, log[k])) {
+            // Gravação interrompida: o resto da página não pode ser reaproveitado
+            s->compact_needed = true;
+            break;
+        }
+        values[RECORD_INDEX(log[k])] = RECORD_VALUE(log[k]);
+    }
+    s->replayed = k;
+
+    // Continua o log de onde parou, com a imagem da página já gravada
+    s->log_page = (uint16_t)(first + k / RECORDS_PER_PAGE);
+    s->page_used = (uint16_t)(k % RECORDS_PER_PAGE);
+    if (s->log_page < PAGES_PER_SECTOR) memcpy(s->page, log + (k - s->page_used), s->page_used * 4u);
+    return true;
+}
+
+void flash_store_record(flash_store_t *s, uint16_t index, uint16_t value) {
+    if (!s->enabled || s->compact_needed) return;  // o snapshot levará o valor
+    if (s->num_pending == FLASH_STORE_PENDING_MAX) {
+        s->compact_needed = true;
+        return;
+    }
+    s->pending[s->num_pending++] = make_record(index, value);
+}
+
+bool flash_store_flush(flash_store_t *s) {
+    if (!s->enabled) return true;
+    if (s->compact_needed) return compact(s);
+
+    uint16_t i = 0;
+    while (i < s->num_pending) {
+        if (s->log_page >= PAGES_PER_SECTOR) return compact(s);
+        while (i < s->num_pending && s->page_used < RECORDS_PER_PAGE) {
+            s->page[s->page_used++] = s->pending[i++];
+        }
+        if (!program_page(s->sector, s->log_page, s->page)) {
+            s->compact_needed = true;
+            return false;
+        }
+        if (s->page_used == RECORDS_PER_PAGE) {
+            s->log_page++;
+            reset_page(s);
+        }
+    }
+    s->num_pending = 0;
+    return true;
+}
@@ -0,0 +1,297 @@
+/**
+ * Parser HTTP incremental, sem alocação.
+ *
+ * Os bytes são consumidos direto dos buffers de recepção (payload dos pbufs),
+ * um segmento por vez, e o estado fica salvo entre chamadas. Só são copiados o
+ * método, o caminho, os parâmetros da query string e o valor dos cabeçalhos
+ * que o servidor usa; o restante das linhas de cabeçalho é pulado com memchr.
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "http_parser.h"
+
+enum {
+    ST_METHOD = 0,
+    ST_PATH,
+    ST_QUERY_KEY,
+    ST_QUERY_VALUE,
+    ST_VERSION,
+    ST_HEADER_START,
+    ST_HEADER_NAME,
+    ST_HEADER_VALUE,
+    ST_SKIP_LINE,
+    ST_DONE,
+    ST_ERROR,
+};
+
+// Tabela de cabeçalhos reconhecidos (nomes em minúsculas)
+static const struct {
+    const char *name;
+    http_header_id_t id;
+} known_headers[] = {
+    { "connection",    HTTP_HEADER_CONNECTION },
+    { "if-none-match", HTTP_HEADER_IF_NONE_MATCH },
+    { "upgrade",       HTTP_HEADER_UPGRADE },
+    { "sec-websocket-key", HTTP_HEADER_WEBSOCKET_KEY },
+    { "content-length", HTTP_HEADER_CONTENT_LENGTH },
+    { "accept-encoding", HTTP_HEADER_ACCEPT_ENCODING },
+    { "host",          HTTP_HEADER_HOST },
+};
+
+void http_parser_reset(http_parser_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->state = ST_METHOD;
+}
+
+static http_parse_result_t fail(http_parser_t *p, uint16_t status) {
+    p->state = ST_ERROR;
+    p->status = status;
+    return HTTP_PARSE_ERROR;
+}
+
+// Procura token (sem diferenciar maiúsculas) dentro do valor de um cabeçalho
+static bool value_has_token(const char *value, const char *token) {
+    size_t n = strlen(token);
+    for (; *value; value++) {
+        size_t i = 0;
+        while (i < n && tolower((unsigned char)value[i]) == token[i]) i++;
+        if (i == n) return true;
+    }
+    return false;
+}
+
+static void resolve_method(http_parser_t *p) {
+    p->tok[p->tok_len] = '\0';
+    if (strcmp(p->tok, "GET") == 0) p->method = HTTP_METHOD_GET;
+    else if (strcmp(p->tok, "POST") == 0) p->method = HTTP_METHOD_POST;
+    else p->method = HTTP_METHOD_UNKNOWN;
+}
+
+static http_header_id_t resolve_header(http_parser_t *p) {
+    p->tok[p->tok_len] = '\0';
+    for (size_t i = 0; i < sizeof(known_headers) / sizeof(known_headers[0]); i++) {
+        if (strcmp(p->tok, known_headers[i].name) == 0) return known_headers[i].id;
+    }
+    return HTTP_HEADER_NONE;
+}
+
+// Aplica o valor de um cabeçalho reconhecido ao resultado
+static void apply_header(http_parser_t *p) {
+    switch (p->header) {
+    case HTTP_HEADER_CONNECTION:
+        if (value_has_token(p->hvalue, "close")) p->keep_alive = false;
+        else if (value_has_token(p->hvalue, "keep-alive")) p->keep_alive = true;
+        if (value_has_token(p->hvalue, "upgrade")) p->connection_upgrade = true;
+        break;
+    case HTTP_HEADER_UPGRADE:
+        if (value_has_token(p->hvalue, "websocket")) p->upgrade_websocket = true;
+        break;
+    case HTTP_HEADER_CONTENT_LENGTH: {
+        uint32_t n = 0;
+        const char *v = p->hvalue;
+        if (!isdigit((unsigned char)*v)) break;
+        for (; isdigit((unsigned char)*v) && n <= 0xFFFFFF; v++) n = n * 10 + (uint32_t)(*v - '0');
+        p->content_length = n;
+        p->has_content_length = true;
+        break;
+    }
+    case HTTP_HEADER_ACCEPT_ENCODING:
+        if (value_has_token(p->hvalue, "gzip")) p->accept_gzip = true;
+        break;
+    case HTTP_HEADER_WEBSOCKET_KEY:
+        strncpy(p->websocket_key, p->hvalue, sizeof(p->websocket_key) - 1);
+        p->websocket_key[sizeof(p->websocket_key) - 1] = '\0';
+        break;
+    case HTTP_HEADER_HOST:
+        strncpy(p->host, p->hvalue, sizeof(p->host) - 1);
+        p->host[sizeof(p->host) - 1] = '\0';
+        break;
+    case HTTP_HEADER_IF_NONE_MATCH:
+        strncpy(p->if_none_match, p->hvalue, sizeof(p->if_none_match) - 1);
+        p->if_none_match[sizeof(p->if_none_match) - 1] = '\0';
+        break;
+    default:
+        break;
+    }
+}
+
+// Fecha o parâmetro atual da query string
+static void commit_param(http_parser_t *p) {
+    if (p->num_params < HTTP_MAX_PARAMS && p->params[p->num_params].key[0] != '\0') {
+        p->num_params++;
+    }
+    if (p->num_params < HTTP_MAX_PARAMS) {
+        memset(&p->params[p->num_params], 0, sizeof(http_param_t));
+    }
+    p->tok_len = 0;
+}
+
+static void param_append(char *dest, size_t dest_size, uint8_t *len, char c) {
+    if (*len < dest_size - 1) {
+        dest[(*len)++] = c;
+        dest[*len] = '\0';
+    }
+}
+
+bool http_etag_match(const char *header, const char *etag) {
+    size_t etag_len = strlen(etag);
+    const char *p = header;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        const char *end = strchr(p, ',');
+        if (!end) end = p + strlen(p);
+        const char *e = end;
+        while (e > p && (e[-1] == ' ' || e[-1] == '\t')) e--;
+        size_t n = (size_t)(e - p);
+        if (n == 1 && *p == '*') return true;
+        // Comparação fraca: W/"x" equivale a "x"
+        if (n > 2 && p[0] == 'W' && p[1] == '/') {
+            p += 2;
+            n -= 2;
+        }
+        if (n > 0 && n == etag_len && memcmp(p, etag, n) == 0) return true;
+        p = end;
+    }
+    return false;
+}
+
+http_parse_result_t http_parser_feed(http_parser_t *p, const char *data, size_t len, size_t *consumed) {
+    size_t i = 0;
+    http_parse_result_t result = HTTP_PARSE_INCOMPLETE;
+
+    *consumed = 0;
+    if (p->state == ST_DONE) return HTTP_PARSE_COMPLETE;
+    if (p->state == ST_ERROR) return HTTP_PARSE_ERROR;
+
+    while (i < len) {
+        if (p->state == ST_SKIP_LINE) {
+            // Cabeçalho sem interesse: pula até o fim da linha sem inspecionar byte a byte
+            const char *nl = memchr(data + i, '\n', len - i);
+            size_t n = nl ? (size_t)(nl - (data + i)) + 1 : len - i;
+            i += n;
+            if ((p->header_bytes += n) > HTTP_HEADERS_MAX) { result = fail(p, 431); break; }
+            if (nl) p->state = ST_HEADER_START;
+            continue;
+        }
+
+        char c = data[i++];
+        if (++p->header_bytes > HTTP_HEADERS_MAX) { result = fail(p, 431); break; }
+
+        switch (p->state) {
+        case ST_METHOD:
+            if (c == ' ') {
+                resolve_method(p);
+                p->tok_len = 0;
+                p->state = ST_PATH;
+            } else if (c >= 'A' && c <= 'Z' && p->tok_len < HTTP_METHOD_MAX - 1) {
+                p->tok[p->tok_len++] = c;
+            } else if ((c == '\r' || c == '\n') && p->tok_len == 0) {
+                // linhas vazias entre requisições pipelined são toleradas
+                p->header_bytes = 0;
+            } else {
+                result = fail(p, 400);
+            }
+            break;
+
+        case ST_PATH:
+            if ((c == ' ' || c == '?') && p->path_len > 0) {
+                p->path[p->path_len] = '\0';
+                p->state = (c == '?') ? ST_QUERY_KEY : ST_VERSION;
+                p->tok_len = 0;
+            } else if (c == ' ' || c == '\r' || c == '\n' || (p->path_len == 0 && c != '/')) {
+                result = fail(p, 400);
+            } else if (p->path_len < HTTP_PATH_MAX - 1) {
+                p->path[p->path_len++] = c;
+            } else {
+                result = fail(p, 414);
+            }
+            break;
+
+        case ST_QUERY_KEY:
+        case ST_QUERY_VALUE:
+            if (c == '&' || c == ' ') {
+                commit_param(p);
+                p->state = (c == ' ') ? ST_VERSION : ST_QUERY_KEY;
+            } else if (c == '=' && p->state == ST_QUERY_KEY) {
+                p->tok_len = 0;
+                p->state = ST_QUERY_VALUE;
+            } else if (c == '\r' || c == '\n') {
+                result = fail(p, 400);
+            } else if (p->num_params < HTTP_MAX_PARAMS) {
+                http_param_t *param = &p->params[p->num_params];
+                if (p->state == ST_QUERY_KEY)
+                    param_append(param->key, sizeof(param->key), &p->tok_len, c);
+                else
+                    param_append(param->value, sizeof(param->value), &p->tok_len, c);
+            } else {
+                // Parâmetro além do limite: descartá-lo mudaria o pedido em silêncio
+                result = fail(p, 400);
+            }
+            break;
+
+        case ST_VERSION:
+            if (c == '\n') {
+                p->tok[p->tok_len] = '\0';
+                if (strncmp(p->tok, "HTTP/1.", 7) != 0 || !isdigit((unsigned char)p->tok[7])) {
+                    result = fail(p, 400);
+                    break;
+                }
+                p->http_minor = (uint8_t)(p->tok[7] - '0');
+                p->keep_alive = (p->http_minor >= 1);
+                p->tok_len = 0;
+                p->state = ST_HEADER_START;
+            } else if (c != '\r' && p->tok_len < 8) {
+                p->tok[p->tok_len++] = c;
+            }
+            break;
+
+        case ST_HEADER_START:
+            if (c == '\n') {
+                p->state = ST_DONE;
+                result = HTTP_PARSE_COMPLETE;
+            } else if (c != '\r') {
+                p->tok[0] = (char)tolower((unsigned char)c);
+                p->tok_len = 1;
+                p->state = ST_HEADER_NAME;
+            }
+            break;
+
+        case ST_HEADER_NAME:
+            if (c == ':') {
+                p->header = resolve_header(p);
+                p->tok_len = 0;
+                p->hvalue[0] = '\0';
+                p->state = (p->header == HTTP_HEADER_NONE) ? ST_SKIP_LINE : ST_HEADER_VALUE;
+            } else if (c == '\n') {
+                p->state = ST_HEADER_START;  // linha malformada: ignora
+            } else if (p->tok_len < HTTP_HEADER_NAME_MAX - 1) {
+                p->tok[p->tok_len++] = (char)tolower((unsigned char)c);
+            } else {
+                p->state = ST_SKIP_LINE;     // nome longo demais: não é de interesse
+            }
+            break;
+
+        case ST_HEADER_VALUE:
+            if (c == '\n') {
+                apply_header(p);
+                p->state = ST_HEADER_START;
+            } else if (c == '\r' || ((c == ' ' || c == '\t') && p->tok_len == 0)) {
+                // ignora CR e espaços iniciais
+            } else if (p->tok_len < HTTP_HEADER_VALUE_MAX - 1) {
+                p->hvalue[p->tok_len++] = c;
+                p->hvalue[p->tok_len] = '\0';
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (result != HTTP_PARSE_INCOMPLETE) break;
+    }
+
+    *consumed = i;
+    return result;
+}
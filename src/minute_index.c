@@ -0,0 +1,152 @@
+/**
+ * Índice da ocupação por minuto do último dia, para somas e picos de faixas
+ * de tempo sem percorrer os 1440 minutos a cada consulta. Em prédios com mais
+ * de 5 andares o bloco de minutos é dividido entre todos, e a janela de cada
+ * andar encolhe na mesma proporção.
+ *
+ * As somas ficam numa árvore de Fenwick e os picos numa árvore de segmentos
+ * iterativa (folhas no fim do vetor). As duas são circulares como as séries
+ * de timeseries.c: ao entrar num minuto novo, o slot de uma janela atrás é
+ * substituído (a Fenwick recebe a diferença). Como na série, o tempo passado
+ * com a ocupação anterior só é somado quando o andar volta a mudar ou é
+ * consultado. As somas são de 32 bits em aritmética modular: uma faixa é
+ * exata enquanto o total dela couber em 32 bits (média de até ~49 mil
+ * pessoas no dia inteiro).
+ */
+
+#include <string.h>
+
+#include "minute_index.h"
+
+/* ─── ÁRVORE DE FENWICK (SOMAS) ──────────────────────────────────────── */
+static void sum_add(minute_index_floor_t *f, uint32_t slot, uint32_t delta) {
+    for (uint32_t i = slot + 1; i <= f->slots; i += i & -i) f->sum[i - 1] += delta;
+}
+
+// Soma dos slots [0, end)
+static uint32_t sum_prefix(const minute_index_floor_t *f, uint32_t end) {
+    uint32_t s = 0;
+    for (uint32_t i = end; i > 0; i -= i & -i) s += f->sum[i - 1];
+    return s;
+}
+
+/* ─── ÁRVORE DE SEGMENTOS (PICOS) ────────────────────────────────────── */
+static void peak_set(minute_index_floor_t *f, uint32_t slot, uint16_t value) {
+    uint32_t i = slot + f->slots;
+    f->peak[i] = value;
+    for (i >>= 1; i >= 1; i >>= 1) {
+        uint16_t m = f->peak[2 * i] > f->peak[2 * i + 1] ? f->peak[2 * i] : f->peak[2 * i + 1];
+        if (f->peak[i] == m) break;  // os ancestrais não mudam
+        f->peak[i] = m;
+    }
+}
+
+// Maior valor nos slots [lo, hi)
+static uint16_t peak_range(const minute_index_floor_t *f, uint32_t lo, uint32_t hi) {
+    uint16_t m = 0;
+    for (lo += f->slots, hi += f->slots; lo < hi; lo >>= 1, hi >>= 1) {
+        if ((lo & 1) && f->peak[lo] > m) m = f->peak[lo];
+        if (lo & 1) lo++;
+        if ((hi & 1) && f->peak[hi - 1] > m) m = f->peak[hi - 1];
+    }
+    return m;
+}
+
+/* ─── MINUTOS ────────────────────────────────────────────────────────── */
+// Substitui o conteúdo do slot do minuto p (o de uma janela atrás)
+static void reset_minute(minute_index_floor_t *f, uint32_t p, uint32_t person_s, uint16_t peak) {
+    uint32_t slot = p % f->slots;
+    uint32_t old = sum_prefix(f, slot + 1) - sum_prefix(f, slot);
+    sum_add(f, slot, person_s - old);
+    peak_set(f, slot, peak);
+}
+
+// Todos os slots com a mesma ocupação, exceto o do minuto atual: O(n)
+static void rebuild(minute_index_floor_t *f, uint32_t now_s) {
+    for (uint32_t i = 0; i < f->slots; i++) {
+        f->sum[i] = (uint32_t)f->count * 60u * (uint32_t)((i + 1) & -(i + 1));
+        f->peak[f->slots + i] = f->count;
+    }
+    for (uint32_t i = f->slots - 1; i >= 1; i--) f->peak[i] = f->count;
+    reset_minute(f, now_s / 60, (uint32_t)f->count * (now_s % 60), f->count);
+}
+
+// Soma a integral até now_s, substituindo os minutos que começaram no caminho
+static void advance(minute_index_floor_t *f, uint32_t now_s) {
+    if (now_s <= f->last_s) return;
+    uint32_t p0 = f->last_s / 60;
+    uint32_t p1 = now_s / 60;
+    if (p0 == p1) {
+        sum_add(f, p0 % f->slots, (uint32_t)f->count * (now_s - f->last_s));
+    } else if (p1 - p0 >= f->slots) {
+        rebuild(f, now_s);
+    } else {
+        sum_add(f, p0 % f->slots, (uint32_t)f->count * ((p0 + 1) * 60 - f->last_s));
+        for (uint32_t p = p0 + 1; p < p1; p++) reset_minute(f, p, (uint32_t)f->count * 60u, f->count);
+        reset_minute(f, p1, (uint32_t)f->count * (now_s - p1 * 60), f->count);
+    }
+    f->last_s = now_s;
+}
+
+/* ─── API ────────────────────────────────────────────────────────────── */
+void minute_index_init(minute_index_t *mi, uint8_t num_floors, uint32_t now_s, const uint16_t *counts) {
+    memset(mi, 0, sizeof(*mi));
+    mi->start_s = now_s;
+    mi->num_floors = (num_floors > MINUTE_INDEX_MAX_FLOORS) ? MINUTE_INDEX_MAX_FLOORS : num_floors;
+    if (mi->num_floors == 0) return;
+    uint32_t slots = MINUTE_INDEX_POOL_SLOTS / mi->num_floors;
+    if (slots > MINUTE_INDEX_SLOTS) slots = MINUTE_INDEX_SLOTS;
+    for (uint8_t i = 0; i < mi->num_floors; i++) {
+        minute_index_floor_t *f = &mi->floors[i];
+        f->sum = &mi->sum_pool[i * slots];
+        f->peak = &mi->peak_pool[2 * i * slots];
+        f->slots = (uint16_t)slots;
+        f->count = counts[i];
+        f->last_s = now_s;
+        peak_set(f, (now_s / 60) % f->slots, f->count);
+    }
+}
+
+void minute_index_set(minute_index_t *mi, uint8_t floor, uint32_t now_s, uint32_t count) {
+    if (floor >= mi->num_floors) return;
+    minute_index_floor_t *f = &mi->floors[floor];
+    advance(f, now_s);
+    f->count = (count > UINT16_MAX) ? UINT16_MAX : (uint16_t)count;
+    uint32_t slot = (f->last_s / 60) % f->slots;
+    if (f->count > f->peak[f->slots + slot]) peak_set(f, slot, f->count);
+}
+
+bool minute_index_query(minute_index_t *mi, uint8_t floor, uint32_t from_s, uint32_t to_s, uint32_t now_s,
+                        minute_index_range_t *range) {
+    if (floor >= mi->num_floors || from_s > to_s) return false;
+    minute_index_floor_t *f = &mi->floors[floor];
+    advance(f, now_s);
+
+    uint32_t last = f->last_s / 60;
+    uint32_t oldest = mi->start_s / 60;
+    if (last - oldest >= f->slots) oldest = last - f->slots + 1;
+    uint32_t lo = from_s / 60;
+    uint32_t hi = to_s / 60;
+    if (lo < oldest) lo = oldest;
+    if (hi > last) hi = last;
+    if (lo > hi) return false;
+
+    // Até slots minutos consecutivos: uma ou duas faixas do anel
+    uint32_t a = lo % f->slots;
+    uint32_t b = hi % f->slots + 1;
+    if (a < b) {
+        range->person_s = sum_prefix(f, b) - sum_prefix(f, a);
+        range->peak = peak_range(f, a, b);
+    } else {
+        range->person_s = sum_prefix(f, f->slots) - sum_prefix(f, a) + sum_prefix(f, b);
+        uint16_t p1 = peak_range(f, a, f->slots);
+        uint16_t p2 = peak_range(f, 0, b);
+        range->peak = p1 > p2 ? p1 : p2;
+    }
+    uint32_t start = lo * 60 > mi->start_s ? lo * 60 : mi->start_s;
+    uint32_t end = (hi + 1) * 60 < f->last_s ? (hi + 1) * 60 : f->last_s;
+    range->first_min = lo;
+    range->last_min = hi;
+    range->seconds = end - start;
+    return true;
+}
@@ -0,0 +1,128 @@
+/**
+ * Presença por crachá em tabela hash de tamanho fixo.
+ *
+ * Entrada, troca de zona e saída custam uma busca com sondagem linear (O(1)
+ * em média com a tabela até 3/4 cheia). Registros vencidos não são procurados
+ * a cada leitura: presence_expire percorre a tabela aos poucos, alguns slots
+ * por chamada, e devolve um vencido de cada vez para o chamador descontar a
+ * contagem da zona.
+ */
+
+#include <string.h>
+
+#include "presence.h"
+
+#define MASK  (PRESENCE_CAPACITY - 1u)
+
+_Static_assert((PRESENCE_CAPACITY & (PRESENCE_CAPACITY - 1)) == 0, "PRESENCE_CAPACITY deve ser potencia de 2");
+_Static_assert(PRESENCE_CAPACITY <= 65536, "sweep e count sao de 16 bits");
+
+// Hash multiplicativo (Fibonacci): espalha IDs sequenciais pela tabela
+static uint32_t home_slot(uint32_t id) {
+    return (id * 2654435761u) >> (32 - __builtin_ctz(PRESENCE_CAPACITY));
+}
+
+// Slot do crachá, ou o slot livre onde ele entraria (found = false)
+static uint32_t find(const presence_table_t *p, uint32_t id, bool *found) {
+    uint32_t i = home_slot(id);
+    while (p->slots[i].id != PRESENCE_EMPTY_ID) {
+        if (p->slots[i].id == id) {
+            *found = true;
+            return i;
+        }
+        i = (i + 1) & MASK;
+    }
+    *found = false;
+    return i;
+}
+
+// Remove o slot i e desloca para trás os registros que ficariam inacessíveis
+static void remove_at(presence_table_t *p, uint32_t i) {
+    uint32_t j = i;
+    for (;;) {
+        j = (j + 1) & MASK;
+        if (p->slots[j].id == PRESENCE_EMPTY_ID) break;
+        uint32_t k = home_slot(p->slots[j].id);
+        // O registro em j pode ocupar o buraco i se sua posição ideal k não
+        // estiver no intervalo circular (i, j]
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            p->slots[i] = p->slots[j];
+            i = j;
+        }
+    }
+    p->slots[i].id = PRESENCE_EMPTY_ID;
+    p->count--;
+}
+
+void presence_init(presence_table_t *p, uint16_t ttl_min) {
+    memset(p, 0, sizeof(*p));
+    p->ttl_min = ttl_min;
+}
+
+presence_result_t presence_checkin(presence_table_t *p, uint32_t id, uint16_t zone, uint16_t now_min,
+                                   uint16_t *old_zone) {
+    bool found;
+    uint32_t i = find(p, id, &found);
+    if (found) {
+        presence_entry_t *e = &p->slots[i];
+        e->seen_min = now_min;
+        if (e->zone == zone) return PRESENCE_REFRESHED;
+        *old_zone = e->zone;
+        e->zone = zone;
+        return PRESENCE_MOVED;
+    }
+    if (p->count >= PRESENCE_MAX_ENTRIES) return PRESENCE_FULL;
+    p->slots[i] = (presence_entry_t){ id, zone, now_min };
+    p->count++;
+    return PRESENCE_ENTERED;
+}
+
+presence_result_t presence_checkout(presence_table_t *p, uint32_t id, uint16_t *old_zone) {
+    bool found;
+    uint32_t i = find(p, id, &found);
+    if (!found) return PRESENCE_NOT_FOUND;
+    *old_zone = p->slots[i].zone;
+    remove_at(p, i);
+    return PRESENCE_LEFT;
+}
+
+bool presence_lookup(const presence_table_t *p, uint32_t id, uint16_t *zone) {
+    bool found;
+    uint32_t i = find(p, id, &found);
+    if (found) *zone = p->slots[i].zone;
+    return found;
+}
+
+bool presence_expire(presence_table_t *p, uint16_t now_min, uint16_t budget, presence_entry_t *expired) {
+    if (p->count == 0) return false;
+    while (budget--) {
+        uint32_t i = p->sweep;
+        const presence_entry_t *e = &p->slots[i];
+        if (e->id != PRESENCE_EMPTY_ID && (uint16_t)(now_min - e->seen_min) >= p->ttl_min) {
+            *expired = *e;
+            // Não avança: o deslocamento pode ter trazido outro registro para i
+            remove_at(p, i);
+            return true;
+        }
+        p->sweep = (uint16_t)((i + 1) & MASK);
+    }
+    return false;
+}
+
+uint16_t presence_remove_zones(presence_table_t *p, uint16_t first, uint16_t count) {
+    uint16_t removed = 0;
+    uint32_t i = 0;
+    while (i < PRESENCE_CAPACITY && p->count > 0) {
+        const presence_entry_t *e = &p->slots[i];
+        if (e->id != PRESENCE_EMPTY_ID && e->zone >= first && e->zone - first < count) {
+            // Não avança: o deslocamento pode ter trazido outro registro para i.
+            // Só vêm registros de depois de i (ou do começo já verificado).
+            remove_at(p, i);
+            removed++;
+        } else {
+            i++;
+        }
+    }
+    return removed;
+}
@@ -0,0 +1,123 @@
+/**
+ * Séries de ocupação por andar em três resoluções (minuto, hora e dia).
+ *
+ * Nada é recalculado a partir dos dados brutos: cada alteração soma à
+ * integral o tempo passado com a ocupação anterior e atualiza mínimo e máximo
+ * do bucket atual de cada resolução. As três resoluções são mantidas lado a
+ * lado, e não agregadas umas das outras, porque a fila de minutos cobre só a
+ * última hora e a de horas só o último dia. Períodos sem alteração são
+ * preenchidos com a ocupação constante quando o andar volta a mudar (ou é
+ * consultado), limitados ao tamanho de cada fila.
+ */
+
+#include <string.h>
+
+#include "timeseries.h"
+
+static const struct {
+    uint32_t period_s;
+    uint16_t slots;
+    uint16_t offset;                     // primeiro bucket da resolução em buckets[]
+} levels[TIMESERIES_LEVELS] = {
+    [TIMESERIES_MINUTE] = { 60,    TIMESERIES_MINUTES, 0 },
+    [TIMESERIES_HOUR]   = { 3600,  TIMESERIES_HOURS,   TIMESERIES_MINUTES },
+    [TIMESERIES_DAY]    = { 86400, TIMESERIES_DAYS,    TIMESERIES_MINUTES + TIMESERIES_HOURS },
+};
+
+static timeseries_bucket_t *slot(timeseries_floor_t *f, int level, uint32_t period) {
+    return &f->buckets[levels[level].offset + period % levels[level].slots];
+}
+
+static void add_person_s(timeseries_bucket_t *b, uint32_t count, uint32_t seconds) {
+    uint64_t sum = b->person_s + (uint64_t)count * seconds;
+    b->person_s = (sum > UINT32_MAX) ? UINT32_MAX : (uint32_t)sum;
+}
+
+static void fill(timeseries_bucket_t *b, uint16_t count, uint32_t seconds) {
+    b->min = b->max = count;
+    b->person_s = 0;
+    add_person_s(b, count, seconds);
+}
+
+// Soma a integral até now_s, fechando os períodos que terminaram no caminho
+static void advance(timeseries_floor_t *f, uint32_t now_s) {
+    if (now_s <= f->last_s) return;
+    for (int l = 0; l < TIMESERIES_LEVELS; l++) {
+        uint32_t period = levels[l].period_s;
+        uint32_t p0 = f->last_s / period;
+        uint32_t p1 = now_s / period;
+        if (p0 == p1) {
+            add_person_s(slot(f, l, p0), f->count, now_s - f->last_s);
+            continue;
+        }
+        add_person_s(slot(f, l, p0), f->count, (p0 + 1) * period - f->last_s);
+        // Períodos inteiros sem alteração; só os que ainda cabem na fila
+        uint32_t p = (p1 - p0 > levels[l].slots) ? p1 - levels[l].slots + 1 : p0 + 1;
+        for (; p < p1; p++) fill(slot(f, l, p), f->count, period);
+        fill(slot(f, l, p1), f->count, now_s - p1 * period);
+    }
+    f->last_s = now_s;
+}
+
+uint32_t timeseries_period_s(timeseries_level_t level) {
+    return levels[level].period_s;
+}
+
+void timeseries_init(timeseries_t *ts, uint8_t num_floors, uint32_t now_s, const uint16_t *counts) {
+    memset(ts, 0, sizeof(*ts));
+    ts->start_s = now_s;
+    ts->num_floors = (num_floors > TIMESERIES_MAX_FLOORS) ? TIMESERIES_MAX_FLOORS : num_floors;
+    for (uint8_t i = 0; i < ts->num_floors; i++) {
+        timeseries_floor_t *f = &ts->floors[i];
+        f->count = counts[i];
+        f->last_s = now_s;
+        for (int l = 0; l < TIMESERIES_LEVELS; l++) {
+            fill(slot(f, l, now_s / levels[l].period_s), f->count, 0);
+        }
+    }
+}
+
+void timeseries_set(timeseries_t *ts, uint8_t floor, uint32_t now_s, uint32_t count) {
+    if (floor >= ts->num_floors) return;
+    timeseries_floor_t *f = &ts->floors[floor];
+    advance(f, now_s);
+    f->count = (count > UINT16_MAX) ? UINT16_MAX : (uint16_t)count;
+    for (int l = 0; l < TIMESERIES_LEVELS; l++) {
+        timeseries_bucket_t *b = slot(f, l, f->last_s / levels[l].period_s);
+        if (f->count < b->min) b->min = f->count;
+        if (f->count > b->max) b->max = f->count;
+    }
+}
+
+uint32_t timeseries_range(timeseries_t *ts, uint8_t floor, timeseries_level_t level,
+                          uint32_t from_s, uint32_t to_s, uint32_t now_s, uint32_t *first) {
+    if (floor >= ts->num_floors || from_s > to_s) return 0;
+    timeseries_floor_t *f = &ts->floors[floor];
+    advance(f, now_s);
+
+    uint32_t period = levels[level].period_s;
+    uint32_t last = f->last_s / period;
+    uint32_t oldest = ts->start_s / period;
+    if (last - oldest >= levels[level].slots) oldest = last - levels[level].slots + 1;
+    uint32_t lo = from_s / period;
+    uint32_t hi = to_s / period;
+    if (lo < oldest) lo = oldest;
+    if (hi > last) hi = last;
+    if (lo > hi) return 0;
+    *first = lo;
+    return hi - lo + 1;
+}
+
+void timeseries_point(const timeseries_t *ts, uint8_t floor, timeseries_level_t level,
+                      uint32_t period, timeseries_point_t *point) {
+    const timeseries_floor_t *f = &ts->floors[floor];
+    const timeseries_bucket_t *b = &f->buckets[levels[level].offset + period % levels[level].slots];
+    uint32_t start = period * levels[level].period_s;
+    uint32_t end = start + levels[level].period_s;
+    if (end > f->last_s) end = f->last_s;
+    point->start_s = start;
+    point->seconds = end - (start > ts->start_s ? start : ts->start_s);
+    point->min = b->min;
+    point->max = b->max;
+    point->person_s = b->person_s;
+}
@@ -0,0 +1,105 @@
+/**
+ * Servidor HTTPS opcional (CHECKIN_HTTPS=ON) sobre altcp_tls + mbedTLS.
+ *
+ * O handshake completo (ECDHE + assinatura ECDSA) leva segundos no RP2040, por
+ * isso o altcp_tls é configurado com cache de sessões (session ID) e tickets
+ * (ver lwipopts.h): um cliente que volta retoma a sessão com um handshake
+ * abreviado, só com criptografia simétrica. Este módulo cria o listener com o
+ * certificado embutido no build e mede os handshakes de cada conexão.
+ *
+ * Só a API pública é usada. O altcp_tls não avisa o fim do handshake numa
+ * conexão aceita, mas só entrega à callback de recepção dados já decifrados:
+ * os primeiros marcam o fim (o cliente envia a requisição assim que recebe o
+ * Finished do servidor; a diferença é meia ida e volta na rede local).
+ *
+ * A retomada é reconhecida pelo segredo mestre, entregue pela callback de
+ * exportação de chaves do contexto da conexão. Uma sessão retomada, por
+ * session ID ou por ticket, reaproveita o segredo mestre da sessão original;
+ * guardamos a impressão digital (SHA-256 truncado) dos segredos das últimas
+ * sessões completas e comparamos a de cada handshake.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "lwip/altcp_tls.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/ssl.h"
+
+#include "tls_server.h"
+#include "tls_cert.h"        // gerado pelo CMake a partir de certs/
+
+static tls_server_stats_t stats;
+
+// Impressões digitais das últimas sessões completas (anel)
+static uint8_t known_keys[TLS_SERVER_KNOWN_SESSIONS][TLS_SERVER_KEY_ID_LEN];
+static uint8_t known_count = 0;
+static uint8_t known_next = 0;
+
+static bool key_is_known(const uint8_t *key_id) {
+    for (uint8_t i = 0; i < known_count; i++) {
+        if (memcmp(known_keys[i], key_id, TLS_SERVER_KEY_ID_LEN) == 0) return true;
+    }
+    return false;
+}
+
+static void key_remember(const uint8_t *key_id) {
+    memcpy(known_keys[known_next], key_id, TLS_SERVER_KEY_ID_LEN);
+    known_next = (uint8_t)((known_next + 1) % TLS_SERVER_KNOWN_SESSIONS);
+    if (known_count < TLS_SERVER_KNOWN_SESSIONS) known_count++;
+}
+
+// Chamada pelo mbedTLS ao derivar as chaves da conexão (completa ou retomada)
+static void export_keys(void *p_expkey, mbedtls_ssl_key_export_type type, const unsigned char *secret,
+                        size_t secret_len, const unsigned char client_random[32],
+                        const unsigned char server_random[32], mbedtls_tls_prf_types tls_prf_type) {
+    if (type != MBEDTLS_SSL_KEY_EXPORT_TLS12_MASTER_SECRET) return;
+    tls_server_conn_t *tc = (tls_server_conn_t *)p_expkey;
+    uint8_t digest[32];
+    if (mbedtls_sha256(secret, secret_len, digest, 0) != 0) return;
+    memcpy(tc->key_id, digest, TLS_SERVER_KEY_ID_LEN);
+    tc->keyed = true;
+}
+
+struct altcp_pcb *tls_server_new(void) {
+    static struct altcp_tls_config *config = NULL;
+    if (!config) {
+        // Os tamanhos incluem o '\0' final, exigido pelo parser PEM
+        config = altcp_tls_create_config_server_privkey_cert(
+            (const u8_t *)TLS_SERVER_KEY, sizeof(TLS_SERVER_KEY), NULL, 0,
+            (const u8_t *)TLS_SERVER_CERT, sizeof(TLS_SERVER_CERT));
+        if (!config) return NULL;
+    }
+    return altcp_tls_new(config, IPADDR_TYPE_ANY);
+}
+
+void tls_server_accepted(struct altcp_pcb *pcb, tls_server_conn_t *tc, uint32_t now_ms) {
+    memset(tc, 0, sizeof(*tc));
+    tc->handshaking = true;
+    tc->accepted_ms = now_ms;
+    mbedtls_ssl_context *ssl = (mbedtls_ssl_context *)altcp_tls_context(pcb);
+    if (ssl) mbedtls_ssl_set_export_keys_cb(ssl, export_keys, tc);
+}
+
+void tls_server_handshake_done(tls_server_conn_t *tc, uint32_t now_ms) {
+    if (!tc->handshaking) return;
+    tc->handshaking = false;
+    uint32_t ms = now_ms - tc->accepted_ms;
+    stats.handshakes++;
+    stats.last_ms = ms;
+    stats.total_ms += ms;
+    if (stats.handshakes == 1 || ms < stats.min_ms) stats.min_ms = ms;
+    if (ms > stats.max_ms) stats.max_ms = ms;
+    if (!tc->keyed) return;
+    if (key_is_known(tc->key_id)) stats.resumed++;
+    else key_remember(tc->key_id);
+}
+
+void tls_server_closed(tls_server_conn_t *tc) {
+    if (tc->handshaking) stats.failed++;
+    tc->handshaking = false;
+}
+
+const tls_server_stats_t *tls_server_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,271 @@
+/**
+ * Suporte mínimo a WebSocket (RFC 6455) para o servidor HTTP.
+ *
+ * Inclui o cálculo de Sec-WebSocket-Accept (SHA-1 + base64) e um leitor de
+ * frames incremental que trabalha direto sobre os payloads dos pbufs: cada
+ * byte do payload é desmascarado no momento em que é lido, sem cópia
+ * intermediária do frame.
+ */
+
+#include <string.h>
+
+#include "websocket.h"
+
+enum {
+    ST_HDR0 = 0,     // FIN + opcode
+    ST_HDR1,         // MASK + tamanho curto
+    ST_LEN16,
+    ST_LEN64,
+    ST_MASK,
+    ST_PAYLOAD,
+    ST_ERROR,
+};
+
+/* ─── SHA-1 ──────────────────────────────────────────────────────────── */
+typedef struct {
+    uint32_t h[5];
+    uint8_t block[64];
+    uint32_t block_len;
+    uint64_t total_len;
+} sha1_ctx_t;
+
+static uint32_t rol32(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+static void sha1_block(sha1_ctx_t *c) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)c->block[i * 4] << 24) | ((uint32_t)c->block[i * 4 + 1] << 16) |
+               ((uint32_t)c->block[i * 4 + 2] << 8) | (uint32_t)c->block[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = c->h[0], b = c->h[1], d = c->h[3], e = c->h[4], cc = c->h[2];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & cc) | (~b & d);           k = 0x5A827999; }
+        else if (i < 40) { f = b ^ cc ^ d;                    k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & cc) | (b & d) | (cc & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ cc ^ d;                    k = 0xCA62C1D6; }
+        uint32_t t = rol32(a, 5) + f + e + k + w[i];
+        e = d;
+        d = cc;
+        cc = rol32(b, 30);
+        b = a;
+        a = t;
+    }
+    c->h[0] += a;
+    c->h[1] += b;
+    c->h[2] += cc;
+    c->h[3] += d;
+    c->h[4] += e;
+}
+
+static void sha1_init(sha1_ctx_t *c) {
+    c->h[0] = 0x67452301;
+    c->h[1] = 0xEFCDAB89;
+    c->h[2] = 0x98BADCFE;
+    c->h[3] = 0x10325476;
+    c->h[4] = 0xC3D2E1F0;
+    c->block_len = 0;
+    c->total_len = 0;
+}
+
+static void sha1_update(sha1_ctx_t *c, const uint8_t *data, size_t len) {
+    c->total_len += len;
+    while (len--) {
+        c->block[c->block_len++] = *data++;
+        if (c->block_len == 64) {
+            sha1_block(c);
+            c->block_len = 0;
+        }
+    }
+}
+
+static void sha1_final(sha1_ctx_t *c, uint8_t digest[20]) {
+    uint64_t bits = c->total_len * 8;
+    uint8_t pad = 0x80;
+    sha1_update(c, &pad, 1);
+    pad = 0;
+    while (c->block_len != 56) sha1_update(c, &pad, 1);
+    uint8_t len_be[8];
+    for (int i = 0; i < 8; i++) len_be[i] = (uint8_t)(bits >> (56 - 8 * i));
+    sha1_update(c, len_be, 8);
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4]     = (uint8_t)(c->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(c->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(c->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)c->h[i];
+    }
+}
+
+/* ─── HANDSHAKE ──────────────────────────────────────────────────────── */
+void ws_accept_key(const char *client_key, char out[WS_ACCEPT_KEY_SIZE]) {
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    sha1_ctx_t ctx;
+    uint8_t digest[20];
+    sha1_init(&ctx);
+    sha1_update(&ctx, (const uint8_t *)client_key, strlen(client_key));
+    sha1_update(&ctx, (const uint8_t *)guid, sizeof(guid) - 1);
+    sha1_final(&ctx, digest);
+
+    // 20 bytes -> 28 caracteres base64 (o último grupo tem 2 bytes e um '=')
+    size_t o = 0;
+    for (int i = 0; i < 20; i += 3) {
+        uint32_t v = (uint32_t)digest[i] << 16;
+        if (i + 1 < 20) v |= (uint32_t)digest[i + 1] << 8;
+        if (i + 2 < 20) v |= digest[i + 2];
+        out[o++] = b64[(v >> 18) & 0x3F];
+        out[o++] = b64[(v >> 12) & 0x3F];
+        out[o++] = (i + 1 < 20) ? b64[(v >> 6) & 0x3F] : '=';
+        out[o++] = (i + 2 < 20) ? b64[v & 0x3F] : '=';
+    }
+    out[o] = '\0';
+}
+
+/* ─── FRAMES ─────────────────────────────────────────────────────────── */
+size_t ws_frame_header(uint8_t *out, uint8_t opcode, size_t len) {
+    out[0] = 0x80 | (opcode & 0x0F);
+    if (len < 126) {
+        out[1] = (uint8_t)len;
+        return 2;
+    }
+    out[1] = 126;
+    out[2] = (uint8_t)(len >> 8);
+    out[3] = (uint8_t)len;
+    return 4;
+}
+
+void ws_parser_reset(ws_parser_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->state = ST_HDR0;
+}
+
+static ws_parse_result_t fail(ws_parser_t *p, uint16_t code) {
+    p->state = ST_ERROR;
+    p->close_code = code;
+    return WS_PARSE_ERROR;
+}
+
+static bool is_control(uint8_t opcode) {
+    return (opcode & 0x08) != 0;
+}
+
+// Frame terminado: entrega a mensagem se ela estiver completa
+static ws_parse_result_t frame_done(ws_parser_t *p) {
+    p->state = ST_HDR0;
+    if (is_control(p->frame_opcode)) {
+        p->opcode = p->frame_opcode;
+        return WS_PARSE_MESSAGE;
+    }
+    if (!p->frame_fin) return WS_PARSE_INCOMPLETE;  // aguarda continuação
+    p->opcode = p->msg_opcode;
+    p->msg_opcode = 0;
+    return WS_PARSE_MESSAGE;
+}
+
+// Valida o cabeçalho já lido e prepara a leitura do payload
+static ws_parse_result_t header_done(ws_parser_t *p) {
+    // Opcodes reservados (0x3-0x7 e 0xB-0xF) encerram a conexão
+    if (p->frame_opcode > WS_OP_PONG || (p->frame_opcode > WS_OP_BINARY && !is_control(p->frame_opcode))) {
+        return fail(p, 1002);
+    }
+    if (is_control(p->frame_opcode)) {
+        if (!p->frame_fin || p->remaining > WS_MAX_CONTROL) return fail(p, 1002);
+        p->ctl_len = 0;
+    } else {
+        if (p->frame_opcode == WS_OP_CONTINUATION) {
+            if (p->msg_opcode == 0) return fail(p, 1002);
+        } else {
+            if (p->msg_opcode != 0) return fail(p, 1002);  // mensagem anterior incompleta
+            p->msg_opcode = p->frame_opcode;
+            p->msg_len = 0;
+        }
+        // Sem somar: remaining vem do cliente e a soma poderia dar a volta
+        if (p->remaining > WS_MAX_MESSAGE - p->msg_len) return fail(p, 1009);
+    }
+    p->mask_pos = 0;
+    p->state = ST_PAYLOAD;
+    return (p->remaining == 0) ? frame_done(p) : WS_PARSE_INCOMPLETE;
+}
+
+ws_parse_result_t ws_parser_feed(ws_parser_t *p, const uint8_t *data, size_t len, size_t *consumed) {
+    size_t i = 0;
+    ws_parse_result_t result = WS_PARSE_INCOMPLETE;
+
+    while (i < len && result == WS_PARSE_INCOMPLETE) {
+        switch (p->state) {
+        case ST_HDR0:
+            if (data[i] & 0x70) { result = fail(p, 1002); break; }  // RSV sem extensão
+            p->frame_fin = (data[i] & 0x80) != 0;
+            p->frame_opcode = data[i] & 0x0F;
+            i++;
+            p->state = ST_HDR1;
+            break;
+
+        case ST_HDR1: {
+            uint8_t b = data[i++];
+            if (!(b & 0x80)) { result = fail(p, 1002); break; }     // cliente deve mascarar
+            uint8_t n = b & 0x7F;
+            p->remaining = n;
+            p->hdr_pos = 0;
+            if (n == 126) {
+                p->remaining = 0;
+                p->state = ST_LEN16;
+            } else if (n == 127) {
+                p->remaining = 0;
+                p->state = ST_LEN64;
+            } else {
+                p->state = ST_MASK;
+            }
+            break;
+        }
+
+        case ST_LEN16:
+        case ST_LEN64:
+            // RFC 6455: o bit mais alto do tamanho de 64 bits deve ser zero
+            if (p->state == ST_LEN64 && p->hdr_pos == 0 && (data[i] & 0x80)) { result = fail(p, 1002); break; }
+            p->remaining = (p->remaining << 8) | data[i++];
+            if (++p->hdr_pos == (p->state == ST_LEN16 ? 2 : 8)) {
+                p->hdr_pos = 0;
+                p->state = ST_MASK;
+            }
+            break;
+
+        case ST_MASK:
+            p->mask[p->hdr_pos++] = data[i++];
+            if (p->hdr_pos == 4) {
+                p->hdr_pos = 0;
+                result = header_done(p);
+            }
+            break;
+
+        case ST_PAYLOAD: {
+            // Desmascara enquanto copia do pbuf para o destino final
+            size_t n = len - i;
+            if (n > p->remaining) n = (size_t)p->remaining;
+            uint8_t *dest = is_control(p->frame_opcode) ? p->ctl + p->ctl_len : p->msg + p->msg_len;
+            for (size_t k = 0; k < n; k++) {
+                dest[k] = data[i + k] ^ p->mask[p->mask_pos];
+                p->mask_pos = (p->mask_pos + 1) & 3;
+            }
+            if (is_control(p->frame_opcode)) p->ctl_len += (uint8_t)n;
+            else p->msg_len += (uint16_t)n;
+            i += n;
+            p->remaining -= n;
+            if (p->remaining == 0) result = frame_done(p);
+            break;
+        }
+
+        default:
+            result = WS_PARSE_ERROR;
+            break;
+        }
+    }
+
+    *consumed = i;
+    return result;
+}
@@ -0,0 +1,80 @@
+// Interface completa do monitor de ocupacao (GET /app).
+//
+// Servido como pacote imutavel em /app/<versao>.js: o nome muda a cada
+// alteracao deste arquivo, entao o navegador guarda o pacote em cache sem
+// revalidar e, depois do primeiro acesso, so trafegam os dados (/api/floors,
+// /events e /api/batch). Estilo e marcacao ficam aqui para que a pagina que
+// carrega o pacote (gerada no firmware) nunca mude.
+(function () {
+  var css = [
+    'body { font-family: sans-serif; margin: 0 auto; max-width: 32em; padding: 1em; }',
+    'h1 { font-size: 1.3em; }',
+    '.andar { display: flex; align-items: center; gap: .5em; padding: .5em; border-bottom: 1px solid #ccc; }',
+    '.andar.sel { background: #eef6ff; }',
+    '.nome { flex: 1; }',
+    '.qtd { min-width: 3em; text-align: right; font-weight: bold; }',
+    '.barra { height: 6px; background: #ddd; border-radius: 3px; overflow: hidden; }',
+    '.barra div { height: 100%; background: #2a8; }',
+    'button { font-size: 1.1em; min-width: 2.4em; padding: .3em; }',
+    '#status { color: #888; font-size: .85em; margin-top: 1em; }'
+  ].join('\n');
+  var style = document.createElement('style');
+  style.textContent = css;
+  document.head.appendChild(style);
+  document.body.innerHTML =
+    '<h1>Monitor de Ocupacao do Predio</h1>' +
+    '<div id="andares"></div>' +
+    '<p><button id="zerar">Zerar todos</button></p>' +
+    '<div id="status">Conectando...</div>';
+
+  var floors = [], capacity = [], names = [], selected = 0;
+  var lista = document.getElementById('andares'), status = document.getElementById('status');
+
+  function nome(i) { return names[i] || (i === 0 ? 'Terreo' : 'Andar ' + i); }
+
+  function render() {
+    lista.innerHTML = '';
+    floors.forEach(function (n, i) {
+      var row = document.createElement('div');
+      row.className = 'andar' + (i === selected ? ' sel' : '');
+      row.innerHTML = '<span class="nome">' + nome(i) + '<div class="barra"><div style="width:' +
+        Math.min(100, n * 100 / (capacity[i] || 50)) + '%"></div></div></span>' +
+        '<button data-op="remove">-</button><span class="qtd">' + n + '</span>' +
+        '<button data-op="add">+</button>';
+      row.querySelectorAll('button').forEach(function (b) {
+        b.onclick = function () { send(i + ',' + b.dataset.op); };
+      });
+      lista.appendChild(row);
+    });
+  }
+
+  function apply(state) {
+    floors = state.floors;
+    // capacidade e nomes vem em /api/floors e no snapshot; o lote so traz as contagens
+    if (state.capacity) capacity = state.capacity;
+    if (state.names) names = state.names;
+    if (state.selected !== undefined) selected = state.selected;
+    render();
+  }
+
+  function send(ops) {
+    fetch('/api/batch', { method: 'POST', body: ops })
+      .then(function (r) { return r.json(); })
+      .then(apply)
+      .catch(function () { status.textContent = 'Falha ao enviar'; });
+  }
+
+  document.getElementById('zerar').onclick = function () { send('*,clear_all'); };
+
+  fetch('/api/floors').then(function (r) { return r.json(); }).then(apply);
+
+  var es = new EventSource('/events');
+  es.addEventListener('snapshot', function (e) { apply(JSON.parse(e.data)); });
+  es.addEventListener('floor', function (e) {
+    var d = JSON.parse(e.data);
+    floors[d.floor] = d.count;
+    render();
+  });
+  es.onopen = function () { status.textContent = 'Atualizacao ao vivo'; };
+  es.onerror = function () { status.textContent = 'Reconectando...'; };
+})();